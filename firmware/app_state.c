@@ -16,6 +16,7 @@
 #include "hardware/pio.h"
 #include "hardware/vreg.h"
 #include "pio_patcher.h"
+#include "ram_stream.h"
 #include "mem_chip.h"
 #include "xoroshiro64starstar.h"
 
@@ -34,16 +35,76 @@ PIO pio; // The PIO block instance (e.g., pio0, pio1)
 uint sm = 0; // The state machine index within the PIO block
 uint offset; // The instruction memory offset where the PIO program is loaded
 
-// Volatile variables for tracking current test status and visualization
-volatile int stat_cur_addr;    // Current memory address being tested
-volatile int stat_old_addr;    // Previous memory address for visualization updates
-volatile int stat_cur_bit;     // Current data bit being tested
-queue_t stat_cur_test;         // Queue to communicate the current test being run to the UI
-volatile int stat_cur_subtest; // Current sub-test phase within a larger test (e.g., March-B phases)
+// Variables for tracking current test status and visualization
+progress_block_t test_progress; // Test position published by core1 for the UI
+volatile int stat_old_addr;     // Previous memory address for visualization updates
+queue_t stat_cur_test;          // Queue to communicate the current test being run to the UI
 
 // Mask for RAM data bits, used to determine the width of the data bus
 uint ram_bit_mask;
 
+// Backend used by the block transfer wrappers in dram_tests.c
+ram_transport_t ram_transport = RAM_TRANSPORT_POLLED;
+// Throughput of each backend in thousands of accesses per second
+uint32_t ram_polled_kaps;
+uint32_t ram_dma_kaps;
+
+// Cells that mismatched in the golden image compares of the last run, summed over passes
+uint32_t golden_mismatch_cells;
+
+// March algorithm run by the March test, picked from the options menu
+march_algorithm_id_t march_algorithm = MARCH_B;
+
+// Test depth profile run by all_ram_tests, picked from the profile menu
+test_profile_id_t test_profile = TEST_PROFILE_THOROUGH;
+
+// Worst row age of each test in microseconds, and the rows past the refresh period
+uint32_t row_age_worst_us[NUM_RAM_TESTS];
+uint32_t row_age_violations[NUM_RAM_TESTS];
+
+// Verify the pseudo-random test on core0 while core1 only issues reads, set from the options menu
+bool split_verify_mode = false;
+
+// Check read-back streams by the DMA sniffer's CRC instead of word by word, set from the options menu
+bool crc_verify_mode = false;
+
+// Keep testing after a failure and map every failing cell, set from the options menu
+bool failure_map_mode = false;
+// Summary of the failure map from the last test run in that mode
+failure_summary_t failure_summary;
+
+// Run the retention-time search as part of the refresh test, set from the options menu
+bool refresh_characterize = false;
+// Searches 5ms to 2s of unrefreshed delay to within about 31ms, over all 8 patterns
+refresh_stress_config_t refresh_stress_config = { .min_delay_ms = 5,
+                                                  .max_delay_ms = 2000,
+                                                  .delay_steps = 64,
+                                                  .pattern_iterations = 8,
+                                                  .test_data_retention = true,
+                                                  .test_charge_pump = false,
+                                                  .progressive_stress = false };
+// Results of the last retention-time search
+refresh_stress_results_t refresh_stress_results;
+
+// Sweep two delay fields instead of running the tests, set from the options menu
+bool shmoo_mode = false;
+// Delay fields swept on the x and y axes, tRCD and tCAC by default, set from the options menu
+uint8_t shmoo_field_x = 3;
+uint8_t shmoo_field_y = 5;
+// Passing points of the last sweep, bit x of row y
+uint32_t shmoo_grid[SHMOO_STEPS];
+
+// Find the fastest passing speed grade instead of running the tests, set from the options menu
+bool bin_mode = false;
+// Fastest grade that passed with margin (-1 if none did), and the margin in cycles
+int8_t bin_grade = -1;
+uint8_t bin_margin;
+
+// Pick the PIO clock per chip and grade that gives the shortest access cycle, set from the options menu
+bool timing_mode = false;
+// Clock and delays chosen for the test in progress
+pio_timing_t pio_timing;
+
 // Array to store seeds for pseudo-random number generation in tests
 uint64_t random_seeds[PSEUDO_VALUES];
 
@@ -68,6 +129,16 @@ const mem_chip_t *chip_list[NUM_CHIPS] = {&ram4027_chip, &ram4116_half_chip, &ra
 gui_listbox_t variants_menu = {7, 40, 220, 0, 4, 0, 0, 0};
 // Definition of the speed grade menu listbox structure (initialized dynamically)
 gui_listbox_t speed_menu = {7, 40, 220, 0, 4, 0, 0, 0};
+// Definition of the test profile menu listbox structure (items filled in with estimated
+// durations, and a last row leading to the options menu)
+char *profile_menu_items[NUM_TEST_PROFILES + 1];
+gui_listbox_t profile_menu = {7, 40, 220, NUM_TEST_PROFILES + 1, 4, TEST_PROFILE_THOROUGH, 0, profile_menu_items};
+// Definition of the options menu listbox structure (items filled in with each option's setting)
+char *options_menu_items[NUM_OPTIONS];
+gui_listbox_t options_menu = {7, 40, 220, NUM_OPTIONS, 4, 0, 0, options_menu_items};
+// Definition of the report listbox structure (lines filled in when a test finishes)
+char *report_menu_items[REPORT_LINES];
+gui_listbox_t report_menu = {7, 40, 220, 0, 4, 0, 0, report_menu_items};
 
 // Current state of the Graphical User Interface (GUI) state machine
 gui_state_t gui_state = SPLASH_SCREEN;
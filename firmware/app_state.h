@@ -7,6 +7,11 @@
 #include "hardware/pio.h"
 #include "gui.h"
 #include "mem_chip.h"
+#include "ram_dma.h"
+#include "progress.h"
+#include "failure_map.h"
+#include "pio_timing.h"
+#include "dram_tests.h"
 
 #define APP_VERSION "Version 0.5"
 
@@ -25,17 +30,61 @@
 // Change the Rotary Encoder sensitivity here (1=high, 2=medium, 4=low)
 #define ENCODER_SENSITIVITY 2
 
+// Set to 1 to verify the pseudo-random and refresh tests against a bit-packed
+// golden image held in SRAM (128KB for the largest chip)
+#define GOLDEN_IMAGE_COMPARE 0
+
+// Set to 1 to track the longest gap between activations of each row and
+// report the worst row age of every test
+#define ROW_AGE_TRACKING 0
+
+// Most lines in the report on the last run
+#define REPORT_LINES 32
+
+// Number of tests run by all_ram_tests
+#define NUM_RAM_TESTS 5
+
+// Core1 time to issue and check one access in the polled loop, in ns. Profile
+// estimates charge no access less, however short the chip's cycle.
+#define ESTIMATE_CPU_NS 60
+
+// Settings per axis of the timing shmoo, covering the whole 5-bit delay field
+#define SHMOO_STEPS 32
+
+// Speed-grade binning: seeds that must pass at a grade, the cycles every delay
+// must be able to lose on top of that, and the most margin measured
+#define BIN_PASSES 3
+#define BIN_MIN_MARGIN 1
+#define BIN_MAX_MARGIN 8
+
 // Enums
 typedef enum {
     SPLASH_SCREEN,
     MAIN_MENU,
     VARIANT_MENU,
     SPEED_MENU,
+    PROFILE_MENU,
+    OPTIONS_MENU,
     DO_SOCKET,
     DO_TEST,
-    TEST_RESULTS
+    TEST_RESULTS,
+    REPORT_VIEW
 } gui_state_t;
 
+// Rows of the options menu, reached from the last row of the profile menu
+typedef enum {
+    OPTION_MARCH,
+    OPTION_FAILURE_MAP,
+    OPTION_RETENTION,
+    OPTION_VERIFY,
+    OPTION_SHMOO,
+    OPTION_SHMOO_X,
+    OPTION_SHMOO_Y,
+    OPTION_BIN,
+    OPTION_CLOCK,
+    NUM_OPTIONS
+} option_id_t;
+
 // Extern declarations for global variables
 
 // PIO
@@ -44,19 +93,71 @@ extern uint sm;
 extern uint offset;
 
 // Test Status
-extern volatile int stat_cur_addr;
+extern progress_block_t test_progress;
 extern volatile int stat_old_addr;
-extern volatile int stat_cur_bit;
 extern queue_t stat_cur_test;
-extern volatile int stat_cur_subtest;
 extern uint ram_bit_mask;
 
+// Block transfer backend and the throughput of each, measured on the first run of a chip and grade
+extern ram_transport_t ram_transport;
+extern uint32_t ram_polled_kaps;
+extern uint32_t ram_dma_kaps;
+
+// Cells that mismatched in the golden image compares of the last run, summed over passes
+extern uint32_t golden_mismatch_cells;
+
+// March algorithm run by the March test
+extern march_algorithm_id_t march_algorithm;
+
+// Test depth profile run by all_ram_tests
+extern test_profile_id_t test_profile;
+
+// Worst row age of each test in microseconds, and the rows past the refresh period
+extern uint32_t row_age_worst_us[NUM_RAM_TESTS];
+extern uint32_t row_age_violations[NUM_RAM_TESTS];
+
+// Split the pseudo-random verify pass across both cores
+extern bool split_verify_mode;
+
+// CRC verification of DMA read-back streams
+extern bool crc_verify_mode;
+
+// Failure map mode and the summary of the last run in it
+extern bool failure_map_mode;
+extern failure_summary_t failure_summary;
+
+// Retention-time characterization in the refresh test
+extern bool refresh_characterize;
+extern refresh_stress_config_t refresh_stress_config;
+extern refresh_stress_results_t refresh_stress_results;
+
+// Timing shmoo mode, the delay fields it sweeps and the pass grid of the last sweep
+extern bool shmoo_mode;
+extern uint8_t shmoo_field_x;
+extern uint8_t shmoo_field_y;
+extern uint32_t shmoo_grid[SHMOO_STEPS];
+
+// Speed-grade binning mode, and the grade and margin found by the last run
+extern bool bin_mode;
+extern int8_t bin_grade;
+extern uint8_t bin_margin;
+
+// Timing mode, and the PIO clock and delays it chose for the current test
+extern bool timing_mode;
+extern pio_timing_t pio_timing;
+
 // GUI
 extern gui_listbox_t *cur_menu;
 extern char *main_menu_items[MAIN_MENU_ITEMS];
 extern gui_listbox_t main_menu;
 extern gui_listbox_t variants_menu;
 extern gui_listbox_t speed_menu;
+extern char *profile_menu_items[NUM_TEST_PROFILES + 1];
+extern gui_listbox_t profile_menu;
+extern char *options_menu_items[NUM_OPTIONS];
+extern gui_listbox_t options_menu;
+extern char *report_menu_items[REPORT_LINES];
+extern gui_listbox_t report_menu;
 extern gui_state_t gui_state;
 extern struct repeating_timer drum_timer;
 
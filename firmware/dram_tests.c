@@ -8,31 +8,37 @@
 
 #include "dram_tests.h"
 #include "app_state.h"
+#include "ram_stream.h"
+#include "ram_dma.h"
+#include "failure_map.h"
+#include "ram_refresh.h"
+#include "row_age.h"
+#include "split_verify.h"
+#include "pio_patcher.h"
 #include "pico/stdlib.h"
 #include "xoroshiro64starstar.h"
+#include <string.h>
 
 // A magic number used for seeding the pseudo-random number generator.
 #define ARTISANAL_NUMBER 42
 
+// Number of addresses transferred per block call
+#define RAM_BLOCK_SIZE 256
+
 // Forward declarations for static (internal) helper functions
-static inline bool me_r0(int a);                                                         // March Element Read 0
-static inline bool me_r1(int a);                                                         // March Element Read 1
-static inline bool me_w0(int a);                                                         // March Element Write 0
-static inline bool me_w1(int a);                                                         // March Element Write 1
-static inline bool marchb_m0(int a);                                                     // March-B element M0
-static inline bool marchb_m1(int a);                                                     // March-B element M1
-static inline bool marchb_m2(int a);                                                     // March-B element M2
-static inline bool marchb_m3(int a);                                                     // March-B element M3
-static inline bool marchb_m4(int a);                                                     // March-B element M4
-static inline bool march_element(int addr_size, bool descending, int algorithm);         // Generic March element execution
-static uint32_t marchb_testbit(uint32_t addr_size);                                      // Executes March-B test for a single bit
-static uint32_t marchb_test(uint32_t addr_size, uint32_t bits);                          // Executes March-B test for all bits
+static void march_set_background(uint32_t d0, uint32_t mask);                            // Sets March data and read mask
+static bool march_element(int addr_size, const march_element_t *e);                      // Executes one March element
+static uint32_t march_run(uint32_t addr_size, const march_algorithm_t *alg);             // Executes all elements of a March
+static uint32_t march_test(uint32_t addr_size, uint32_t bits, const march_algorithm_t *alg); // Executes a March for all bits
 static uint32_t psrand_next_bits(uint32_t bits);                                         // Generates next pseudo-random bits
 static uint32_t psrandom_test(uint32_t addr_size, uint32_t bits);                        // Executes pseudo-random test
 static uint32_t refresh_subtest(uint32_t addr_size, uint32_t bits, uint32_t time_delay); // Executes a refresh subtest
 static uint32_t refresh_test(uint32_t addr_size, uint32_t bits);                         // Executes the refresh test
 static uint32_t checkerboard_test( uint32_t adr_size, uint32_t bits);                    // Executes the checkerboard test
-static uint32_t address_in_address_test(uint32_t addr_size, uint32_t bits);              // Executes the address-in-address test
+static uint32_t address_lines(uint32_t addr_size);                                      // Counts the address lines
+static uint32_t address_in_address_test(uint32_t addr_size, uint32_t bits);              // Executes the address decoder test
+static uint32_t refresh_stress_subtest(uint32_t addr_size, uint32_t bits, uint32_t pattern,
+                                       uint32_t delay_ms, uint32_t bit_mask);            // Executes one retention pass
 
 
 // Test patterns for refresh stress testing
@@ -49,6 +55,171 @@ static const uint32_t refresh_test_patterns[] = {
 
 #define NUM_REFRESH_PATTERNS (sizeof(refresh_test_patterns) / sizeof(refresh_test_patterns[0]))
 
+// One page burst of a solid or checkerboard pattern, starting on an even
+// cell and on an odd one
+static uint32_t pattern_blocks[2][RAM_BLOCK_SIZE];
+
+// Data bits that have mismatched in count_pattern_mismatches since last cleared
+static uint32_t pattern_fail_bits;
+
+// Data buffers for block transfers
+static uint32_t ram_block_out[RAM_BLOCK_SIZE];
+static uint32_t ram_block_in[RAM_BLOCK_SIZE];
+
+// Core1's copy of the test position. Only published to `test_progress` every
+// block or every PROGRESS_INTERVAL addresses, to keep it off the access path.
+static progress_t progress;
+
+// Checked command stream for tests that mix reads and writes
+static ram_check_stream_t test_stream;
+
+#if GOLDEN_IMAGE_COMPARE
+// Largest supported chip is 256K x 4
+#define GOLDEN_IMAGE_WORDS (262144 * 4 / 32)
+
+// Expected contents of the whole chip, packed in row-major walk order, and
+// one block of read-back data packed the same way
+static uint32_t golden_image[GOLDEN_IMAGE_WORDS];
+static uint32_t golden_block[RAM_BLOCK_SIZE * 4 / 32];
+#endif
+
+// Data words used by the March elements for a logical 0 and 1, the values
+// they read back as once masked, and the mask itself
+static uint32_t march_d0;
+static uint32_t march_d1;
+static uint32_t march_e0;
+static uint32_t march_e1;
+static uint32_t march_mask;
+
+// A March element with its ops resolved against the current data background
+typedef struct {
+    uint32_t data[MARCH_MAX_OPS];   // Data word for each write
+    uint32_t expect[MARCH_MAX_OPS]; // Expected read value, or RAM_STREAM_NO_CHECK
+    bool write[MARCH_MAX_OPS];      // True for writes
+    uint8_t num_ops;
+} march_compiled_t;
+
+// Library of March algorithms, indexed by march_algorithm_id_t.
+// UP is also used for elements whose order does not matter.
+static const march_algorithm_t march_algorithms[NUM_MARCH_ALGORITHMS] = {
+    // {(w0); up(r0,w1,r1,w0,r0,w1); up(r1,w0,w1); down(r1,w0,w1,w0); down(r0,w1,w0)}
+    [MARCH_B] = {"March-B", 5, {{MARCH_UP,   1, {MARCH_W0}},
+                                {MARCH_UP,   6, {MARCH_R0, MARCH_W1, MARCH_R1, MARCH_W0, MARCH_R0, MARCH_W1}},
+                                {MARCH_UP,   3, {MARCH_R1, MARCH_W0, MARCH_W1}},
+                                {MARCH_DOWN, 4, {MARCH_R1, MARCH_W0, MARCH_W1, MARCH_W0}},
+                                {MARCH_DOWN, 3, {MARCH_R0, MARCH_W1, MARCH_W0}}}},
+    // {(w0); up(r0,w1); up(r1,w0); down(r0,w1); down(r1,w0); (r0)}
+    [MARCH_C_MINUS] = {"March C-", 6, {{MARCH_UP,   1, {MARCH_W0}},
+                                       {MARCH_UP,   2, {MARCH_R0, MARCH_W1}},
+                                       {MARCH_UP,   2, {MARCH_R1, MARCH_W0}},
+                                       {MARCH_DOWN, 2, {MARCH_R0, MARCH_W1}},
+                                       {MARCH_DOWN, 2, {MARCH_R1, MARCH_W0}},
+                                       {MARCH_UP,   1, {MARCH_R0}}}},
+    // {(w0); up(r0,r0,w0,r0,w1); up(r1,r1,w1,r1,w0); down(r0,r0,w0,r0,w1); down(r1,r1,w1,r1,w0); (r0)}
+    [MARCH_SS] = {"March SS", 6, {{MARCH_UP,   1, {MARCH_W0}},
+                                  {MARCH_UP,   5, {MARCH_R0, MARCH_R0, MARCH_W0, MARCH_R0, MARCH_W1}},
+                                  {MARCH_UP,   5, {MARCH_R1, MARCH_R1, MARCH_W1, MARCH_R1, MARCH_W0}},
+                                  {MARCH_DOWN, 5, {MARCH_R0, MARCH_R0, MARCH_W0, MARCH_R0, MARCH_W1}},
+                                  {MARCH_DOWN, 5, {MARCH_R1, MARCH_R1, MARCH_W1, MARCH_R1, MARCH_W0}},
+                                  {MARCH_UP,   1, {MARCH_R0}}}},
+    // {(w0); down(r0,w1); up(r1,w0,r0,w1); up(r1,w0); up(r0,w1,r1,w0); up(r0)}
+    [MARCH_LR] = {"March LR", 6, {{MARCH_UP,   1, {MARCH_W0}},
+                                  {MARCH_DOWN, 2, {MARCH_R0, MARCH_W1}},
+                                  {MARCH_UP,   4, {MARCH_R1, MARCH_W0, MARCH_R0, MARCH_W1}},
+                                  {MARCH_UP,   2, {MARCH_R1, MARCH_W0}},
+                                  {MARCH_UP,   4, {MARCH_R0, MARCH_W1, MARCH_R1, MARCH_W0}},
+                                  {MARCH_UP,   1, {MARCH_R0}}}},
+    // {(w0); up(r0,w1); down(r1,w0,r0)}
+    [MATS_PLUS_PLUS] = {"MATS++", 3, {{MARCH_UP,   1, {MARCH_W0}},
+                                      {MARCH_UP,   2, {MARCH_R0, MARCH_W1}},
+                                      {MARCH_DOWN, 3, {MARCH_R1, MARCH_W0, MARCH_R0}}}},
+};
+
+// Test depth profiles, indexed by test_profile_id_t. Quick runs the three
+// tests fault_bench finds the most new faults per access with: refresh,
+// address and March. Thorough is the full soak.
+static const test_profile_t test_profiles[NUM_TEST_PROFILES] = {
+    [TEST_PROFILE_QUICK]    = {"Quick",    0x15, 0,             0,  2}, // March, refresh, address
+    [TEST_PROFILE_STANDARD] = {"Standard", 0x1f, 16,            2,  2},
+    [TEST_PROFILE_THOROUGH] = {"Thorough", 0x1f, PSEUDO_VALUES, 10, 2},
+};
+
+// Unrefreshed wait of the refresh test, in percent of the chip's refresh period
+#define REFRESH_TEST_DELAY_PCT 250
+
+// Data backgrounds for word-oriented March tests. Each is also used inverted,
+// so with 1 + log2(bits) of them every cell sees both values and every pair
+// of bits in a word holds opposite values at least once.
+static const uint32_t march_backgrounds[] = {0x00000000, 0x55555555, 0x33333333, 0x0f0f0f0f};
+
+// Command words built for the DMA backend
+static uint32_t ram_dma_cmds[RAM_BLOCK_SIZE];
+
+// Double buffers for the pipelined pseudo-random test. While one set streams
+// to the state machine, the other is filled with the next block.
+static uint32_t psrand_cmds[2][RAM_BLOCK_SIZE];
+static uint32_t psrand_expect[2][RAM_BLOCK_SIZE];
+static uint32_t psrand_results[2][RAM_BLOCK_SIZE];
+
+// CRC32 of each block of the current seed, taken while it is written, and
+// the blocks whose read-back CRC did not match
+#define PSRAND_CRC_BLOCKS 1024
+static uint32_t psrand_crc[PSRAND_CRC_BLOCKS];
+static uint32_t psrand_crc_bad[PSRAND_CRC_BLOCKS / 32];
+
+
+/**
+ * @brief Records the current position and publishes it for the UI.
+ *
+ * @param addr Progress through the current pass, in addresses.
+ */
+static inline void progress_at(uint32_t addr)
+{
+    progress.addr = addr;
+    progress_publish(&test_progress, &progress);
+}
+
+/**
+ * @brief Returns the failure callback for checked streams.
+ *
+ * @return `failure_map_record` when every failure is being mapped, else NULL.
+ */
+static inline ram_fail_fn map_fail_fn()
+{
+    return failure_map_mode ? failure_map_record : NULL;
+}
+
+/**
+ * @brief Compares a block of read data with the expected data.
+ *
+ * In failure map mode every mismatching cell is recorded; otherwise the
+ * compare stops at the first one.
+ *
+ * @param addr The address of the first word of the block.
+ * @param stride The address step between neighbouring words.
+ * @param expect The expected data.
+ * @param data The data read back.
+ * @param count The number of words in the block.
+ * @return True if any word did not match.
+ */
+static bool check_block(uint32_t addr, uint32_t stride, const uint32_t *expect,
+                        const uint32_t *data, uint32_t count)
+{
+    bool failed = false;
+    uint32_t j;
+
+    for (j = 0; j < count; j++)
+    {
+        if (data[j] != expect[j])
+        {
+            if (!failure_map_mode)
+                return true;
+            failure_map_record(addr + j * stride, data[j] ^ expect[j]);
+            failed = true;
+        }
+    }
+    return failed;
+}
 
 /**
  * @brief Reads a data word from the specified RAM address.
@@ -79,584 +250,1802 @@ void ram_write(int addr, int data)
 }
 
 /**
- * @brief Initializes the seeds for the pseudo-random number generator.
+ * @brief Encodes an access into a command word for the selected chip's state machine.
  *
- * Seeds the `xoroshiro64starstar` generator with a fixed artisanal number
- * and then pre-generates a set of pseudo-random seeds for later use in tests.
+ * @param addr The memory address.
+ * @param data The data word (ignored for reads).
+ * @param write True for a write, false for a read.
+ * @return The command word to push to the PIO TX FIFO.
  */
-void psrand_init_seeds()
+uint32_t ram_encode(int addr, int data, bool write)
 {
-    int i;
-    psrand_seed(ARTISANAL_NUMBER);
-    for (i = 0; i < PSEUDO_VALUES; i++)
-    {
-        random_seeds[i] = psrand_next();
-    }
+    return chip_list[main_menu.sel_line]->ram_encode(addr, data, write);
 }
 
 /**
- * @brief Executes all defined RAM tests in sequence.
+ * @brief Encodes a run of accesses into a buffer of command words.
  *
- * Runs March-B, Pseudo-random, and Refresh tests. It updates the UI with the
- * current test being executed and returns the first failure encountered.
- *
- * @param addr_size The total number of addresses in the RAM chip.
- * @param bits The number of data bits in the RAM chip.
- * @return 0 if all tests pass, otherwise a non-zero value indicating failure.
+ * @param cmds Buffer receiving `count` command words.
+ * @param addr The first address of the run.
+ * @param stride The address step between accesses.
+ * @param data The `count` data words to write, or NULL for reads.
+ * @param count The number of accesses.
+ * @param page True to run the accesses as fast page mode bursts.
  */
-uint32_t all_ram_tests(uint32_t addr_size, uint32_t bits)
+static void encode_run(uint32_t *cmds, int addr, int stride, const uint32_t *data,
+                       uint32_t count, bool page)
 {
-    int failed;
-    int test = 0;
-    // March-B Test
-    march_element(addr_size, false, 0);        // Initialize memory for March-B
-    queue_add_blocking(&stat_cur_test, &test); // Update UI with current test
-    failed = marchb_test(addr_size, bits);
-    if (failed)
-        return failed;
-
-    // Pseudo-random Test
-    test = 1;
-    queue_add_blocking(&stat_cur_test, &test); // Update UI with current test
-    failed = psrandom_test(addr_size, bits);
-    if (failed)
-        return failed;
-
-    // Refresh Test
-    test = 2;
-    queue_add_blocking(&stat_cur_test, &test); // Update UI with current test
-    failed = refresh_test(addr_size, bits);
-    if (failed)
-        return failed;
-
-    // Checkerboard Test
-    test = 3;
-    queue_add_blocking(&stat_cur_test, &test); // Update UI with current test
-    failed = checkerboard_test(addr_size, bits);
-    if (failed)
-        return failed;
-
-    // Address-in-Address Test
-    test = 4;
-    queue_add_blocking(&stat_cur_test, &test);
-    failed = address_in_address_test(addr_size, bits);
-    if (failed) return failed;
+    const mem_chip_t *chip = chip_list[main_menu.sel_line];
+    uint32_t i;
 
-    return 0; // All tests passed
+    for (i = 0; i < count; i++)
+    {
+        cmds[i] = chip->ram_encode(addr + i * stride, data ? data[i] : 0, data != NULL);
+        if (page)
+            cmds[i] |= ram_stream_page_flag(i, count);
+    }
 }
 
-// Static Helper Functions (March-B elements and related operations)
-
 /**
- * @brief March Element: Read 0.
- * @param a The address to read from.
- * @return True if the read value is 0, false otherwise.
+ * @brief Encodes a run of accesses and streams it through the DMA backend.
+ *
+ * @param addr The first address of the run.
+ * @param stride The address step between accesses.
+ * @param data The `count` data words to write, or NULL for reads.
+ * @param results Buffer receiving `count` read results, or NULL for writes.
+ * @param count The number of accesses.
+ * @param page True to run the accesses as fast page mode bursts.
  */
-static inline bool me_r0(int a)
+static void ram_dma_run(int addr, int stride, const uint32_t *data, uint32_t *results,
+                        uint32_t count, bool page)
 {
-    int bit = ram_read(a) & ram_bit_mask;
-    return (bit == 0);
+    uint32_t n;
+
+    while (count)
+    {
+        n = MIN(RAM_BLOCK_SIZE, count);
+        encode_run(ram_dma_cmds, addr, stride, data, n, page);
+        ram_dma_xfer(ram_dma_cmds, results, n);
+
+        addr += n * stride;
+        if (data)
+            data += n;
+        if (results)
+            results += n;
+        count -= n;
+    }
 }
 
 /**
- * @brief March Element: Read 1.
- * @param a The address to read from.
- * @return True if the read value is 1, false otherwise.
+ * @brief Reads a run of consecutive addresses with the accesses pipelined.
+ *
+ * @param addr The first address to read.
+ * @param data Buffer receiving `count` data words.
+ * @param count The number of addresses to read.
  */
-static inline bool me_r1(int a)
+void ram_read_block(int addr, uint32_t *data, uint32_t count)
 {
-    int bit = ram_read(a) & ram_bit_mask;
-    return (bit == ram_bit_mask);
+    ram_refresh_service();
+    row_age_touch_run(addr, 1, count);
+    if (ram_transport == RAM_TRANSPORT_DMA)
+        ram_dma_run(addr, 1, NULL, data, count, false);
+    else
+        chip_list[main_menu.sel_line]->ram_read_block(addr, data, count);
 }
 
 /**
- * @brief March Element: Write 0.
- * @param a The address to write to.
- * @return Always true.
+ * @brief Writes a run of consecutive addresses with the accesses pipelined.
+ *
+ * @param addr The first address to write.
+ * @param data The `count` data words to write.
+ * @param count The number of addresses to write.
  */
-static inline bool me_w0(int a)
+void ram_write_block(int addr, const uint32_t *data, uint32_t count)
 {
-    ram_write(a, ~ram_bit_mask);
-    return true;
+    ram_refresh_service();
+    row_age_touch_run(addr, 1, count);
+    if (ram_transport == RAM_TRANSPORT_DMA)
+        ram_dma_run(addr, 1, data, NULL, count, false);
+    else
+        chip_list[main_menu.sel_line]->ram_write_block(addr, data, count);
 }
 
 /**
- * @brief March Element: Write 1.
- * @param a The address to write to.
- * @return Always true.
+ * @brief Reads a run of columns along one row.
+ *
+ * Successive words come from `addr`, then the next column in the same row
+ * and so on. Chips whose programs support it use fast page mode, so only
+ * the first access of each burst pays for a full RAS cycle.
+ *
+ * @param addr The address of the first column to read.
+ * @param data Buffer receiving `count` data words.
+ * @param count The number of columns to read.
  */
-static inline bool me_w1(int a)
+void ram_read_page(int addr, uint32_t *data, uint32_t count)
 {
-    ram_write(a, ram_bit_mask);
-    return true;
+    const mem_chip_t *chip = chip_list[main_menu.sel_line];
+
+    ram_refresh_service();
+    row_age_touch_run(addr, 1 << chip->row_bits, count);
+
+    if (ram_transport == RAM_TRANSPORT_DMA)
+        ram_dma_run(addr, 1 << chip->row_bits, NULL, data, count, chip->page_mode);
+    else
+        chip->ram_read_page(addr, data, count);
 }
 
 /**
- * @brief March-B Element M0: Write 0.
- * @param a The address to operate on.
- * @return Always true.
+ * @brief Writes a run of columns along one row.
+ *
+ * See `ram_read_page`.
+ *
+ * @param addr The address of the first column to write.
+ * @param data The `count` data words to write.
+ * @param count The number of columns to write.
  */
-static inline bool marchb_m0(int a)
+void ram_write_page(int addr, const uint32_t *data, uint32_t count)
 {
-    me_w0(a);
-    return true;
+    const mem_chip_t *chip = chip_list[main_menu.sel_line];
+
+    ram_refresh_service();
+    row_age_touch_run(addr, 1 << chip->row_bits, count);
+
+    if (ram_transport == RAM_TRANSPORT_DMA)
+        ram_dma_run(addr, 1 << chip->row_bits, data, NULL, count, chip->page_mode);
+    else
+        chip->ram_write_page(addr, data, count);
 }
 
 /**
- * @brief March-B Element M1: Read 0, Write 1, Read 1, Write 0, Read 0, Write 1.
- * @param a The address to operate on.
- * @return True if all operations are successful, false otherwise.
+ * @brief Returns the display name of a March algorithm.
+ *
+ * @param id The March algorithm.
+ * @return The algorithm's name.
  */
-static inline bool marchb_m1(int a)
+const char *march_algorithm_name(march_algorithm_id_t id)
 {
-    return me_r0(a) && me_w1(a) && me_r1(a) && me_w0(a) && me_r0(a) && me_w1(a);
+    return march_algorithms[id].name;
 }
 
 /**
- * @brief March-B Element M2: Read 1, Write 0, Write 1.
- * @param a The address to operate on.
- * @return True if all operations are successful, false otherwise.
+ * @brief Returns the display name of a test profile.
+ *
+ * @param id The test profile.
+ * @return The profile's name.
  */
-static inline bool marchb_m2(int a)
+const char *test_profile_name(test_profile_id_t id)
 {
-    return me_r1(a) && me_w0(a) && me_w1(a);
+    return test_profiles[id].name;
 }
 
 /**
- * @brief March-B Element M3: Read 1, Write 0, Write 1, Write 0.
- * @param a The address to operate on.
- * @return True if all operations are successful, false otherwise.
+ * @brief Returns the unrefreshed wait of the refresh test on the selected chip.
  */
-static inline bool marchb_m3(int a)
+static uint32_t refresh_test_delay_us(void)
 {
-    return me_r1(a) && me_w0(a) && me_w1(a) && me_w0(a);
+    return chip_list[main_menu.sel_line]->refresh_us * REFRESH_TEST_DELAY_PCT / 100;
 }
 
 /**
- * @brief March-B Element M4: Read 0, Write 1, Write 0.
- * @param a The address to operate on.
- * @return True if all operations are successful, false otherwise.
+ * @brief Returns the number of patterns the retention-time search runs.
  */
-static inline bool marchb_m4(int a)
+static uint32_t retention_search_patterns(void)
 {
-    return me_r0(a) && me_w1(a) && me_w0(a);
+    return MIN(MAX(refresh_stress_config.pattern_iterations, 1), NUM_REFRESH_PATTERNS);
 }
 
 /**
- * @brief Executes a single March test element (e.g., M0, M1, M2, M3, M4).
+ * @brief Counts the accesses `all_ram_tests` makes in a test profile.
  *
- * Iterates through memory addresses (ascending or descending) and applies
- * the specified March algorithm. Updates `stat_cur_addr` and `stat_cur_subtest`
- * for UI visualization.
+ * Includes the March initialization before the tests and the transport
+ * measurement made on the first run of a chip and speed grade, but not the
+ * refresh cycles between them. The retention-time search, when it is on,
+ * is counted as one fill and check per pattern, as on a chip that keeps
+ * every pattern for the longest delay searched.
  *
- * @param addr_size The total number of addresses to test.
- * @param descending If true, iterate addresses in descending order; otherwise, ascending.
- * @param algorithm The index of the March algorithm to execute (0-4 for M0-M4).
- * @return True if all operations in the element pass, false otherwise.
+ * @param id The test profile.
+ * @param addr_size The total number of addresses in the RAM chip.
+ * @param bits The number of data bits in the RAM chip.
+ * @return The number of reads and writes.
  */
-static inline bool march_element(int addr_size, bool descending, int algorithm)
+uint64_t test_profile_accesses(test_profile_id_t id, uint32_t addr_size, uint32_t bits)
 {
-    int inc = descending ? -1 : 1;                // Increment/decrement step
-    int start = descending ? (addr_size - 1) : 0; // Starting address
-    int end = descending ? -1 : addr_size;        // Ending condition
-    int a;
-    bool ret;
-
-    stat_cur_subtest = algorithm; // Update current subtest for UI visualization
-
-    // Iterate through addresses and apply the selected March algorithm
-    for (stat_cur_addr = start; stat_cur_addr != end; stat_cur_addr += inc)
+    const test_profile_t *p = &test_profiles[id];
+    const march_algorithm_t *alg = &march_algorithms[march_algorithm];
+    uint64_t passes = 4; // Write and read with each transport, on the first run
+    uint32_t walks = 0;
+    uint32_t lines;
+    uint32_t ops = 0;
+    uint32_t bg;
+    uint8_t i;
+
+    if (p->tests & 0x01)
     {
-        switch (algorithm)
-        {
-        case 0:
-            ret = marchb_m0(stat_cur_addr);
-            break;
-        case 1:
-            ret = marchb_m1(stat_cur_addr);
-            break;
-        case 2:
-            ret = marchb_m2(stat_cur_addr);
-            break;
-        case 3:
-            ret = marchb_m3(stat_cur_addr);
-            break;
-        case 4:
-            ret = marchb_m4(stat_cur_addr);
-            break;
-        default:
-            ret = false; // Should not happen with valid algorithm indices
-            break;
-        }
-        if (!ret)
-            return false; // Return false immediately on first failure
+        for (i = 0; i < alg->num_elements; i++)
+            ops += alg->elements[i].num_ops;
+        for (bg = 0; (bg < count_of(march_backgrounds)) && ((1u << bg) <= bits); bg++)
+            passes += ops;
+        passes += alg->elements[0].num_ops; // Initialization
     }
-    return true;
+    if (p->tests & 0x02)
+        passes += 2 * p->pseudo_seeds;
+    if (p->tests & 0x04)
+    {
+        passes += 2;
+        if (refresh_characterize)
+            passes += 2 * retention_search_patterns();
+    }
+    if (p->tests & 0x08)
+        passes += 4 * p->checkerboard_loops;
+    if (p->tests & 0x10)
+    {
+        lines = address_lines(addr_size);
+        walks = 4 * (lines + 1) * (lines + 3); // Walking one and zero over both backgrounds
+        passes += 2 * p->address_sweeps;
+    }
+    return passes * addr_size + walks;
 }
 
 /**
- * @brief Executes the full March-B test for a single data bit.
+ * @brief Counts the accesses of a test profile that `all_ram_tests` makes in row bursts.
  *
- * Calls `march_element` for each phase of the March-B algorithm.
+ * The pseudo-random, refresh and checkerboard tests walk the chip a row at
+ * a time and use page mode on chips that have it. The rest of the accesses
+ * counted by `test_profile_accesses` are random.
  *
+ * @param id The test profile.
  * @param addr_size The total number of addresses in the RAM chip.
- * @return True if the March-B test passes for the current bit, false otherwise.
- */
-static uint32_t marchb_testbit(uint32_t addr_size)
-{
-    bool ret;
-    ret = march_element(addr_size, false, 0); // M0 (w0) in ascending order
-    if (!ret)
-        return false;
-    ret = march_element(addr_size, false, 1); // M1 (r0,w1,r1,w0,r0,w1) in ascending order
-    if (!ret)
-        return false;
-    ret = march_element(addr_size, false, 2); // M2 (r1,w0,w1) in ascending order
-    if (!ret)
-        return false;
-    ret = march_element(addr_size, true, 3); // M3 (r1,w0,w1,w0) in descending order
-    if (!ret)
-        return false;
-    ret = march_element(addr_size, true, 4); // M4 (r0,w1,w0) in descending order
-    if (!ret)
-        return false;
-    return true;
+ * @return The number of reads and writes made in row bursts.
+ */
+uint64_t test_profile_page_accesses(test_profile_id_t id, uint32_t addr_size)
+{
+    const test_profile_t *p = &test_profiles[id];
+    uint64_t passes = 0;
+
+    if (p->tests & 0x02)
+        passes += 2 * p->pseudo_seeds;
+    if (p->tests & 0x04)
+    {
+        passes += 2;
+        if (refresh_characterize)
+            passes += 2 * retention_search_patterns();
+    }
+    if (p->tests & 0x08)
+        passes += 4 * p->checkerboard_loops;
+    return passes * addr_size;
 }
 
 /**
- * @brief Executes the March-B test for all data bits of the RAM chip.
+ * @brief Returns the time a test profile spends waiting rather than accessing the chip.
  *
- * Iterates through each data bit, sets the `ram_bit_mask` accordingly,
- * and calls `marchb_testbit`. Accumulates failure flags for each bit.
+ * The retention-time search, when it is on, waits the longest delay once
+ * per pattern on a chip that passes it. A chip that loses a pattern sooner
+ * takes up to log2(delay_steps) more waits for that pattern.
  *
- * @param addr_size The total number of addresses in the RAM chip.
- * @param bits The number of data bits in the RAM chip.
- * @return A bitmask where each set bit indicates a failure in the corresponding data bit.
+ * @param id The test profile.
+ * @return The wait in microseconds.
  */
-static uint32_t marchb_test(uint32_t addr_size, uint32_t bits)
+uint32_t test_profile_wait_us(test_profile_id_t id)
 {
-    int failed = 0;
-    int bit = 0;
+    uint32_t wait_us = 0;
 
-    // Iterate through each data bit
-    for (bit = 0; bit < bits; bit++)
+    if (test_profiles[id].tests & 0x04)
     {
-        stat_cur_bit = bit;      // Update current bit for UI visualization
-        ram_bit_mask = 1 << bit; // Set mask for the current bit
-        if (!marchb_testbit(addr_size))
-        {
-            failed |= 1 << bit; // Set failure flag for this bit
-        }
+        wait_us = refresh_test_delay_us();
+        if (refresh_characterize)
+            wait_us += retention_search_patterns() * refresh_stress_config.max_delay_ms * 1000;
     }
-
-    return (uint32_t)failed;
+    return wait_us;
 }
 
 /**
- * @brief Generates the next `bits` number of pseudo-random bits.
- *
- * Uses the `xoroshiro64starstar` generator to produce 32-bit random numbers
- * and extracts the requested number of bits from it.
+ * @brief Initializes the seeds for the pseudo-random number generator.
  *
- * @param bits The number of bits to generate (1 to 32).
- * @return A `uint32_t` containing the generated pseudo-random bits.
+ * Seeds the `xoroshiro64starstar` generator with a fixed artisanal number
+ * and then pre-generates a set of pseudo-random seeds for later use in tests.
  */
-static uint32_t psrand_next_bits(uint32_t bits)
+void psrand_init_seeds()
 {
-    static int bitcount = 0;  // Number of remaining bits in current `cur_rand`
-    static uint32_t cur_rand; // Current 32-bit random number
-    uint32_t out;
-
-    // If not enough bits left in `cur_rand`, generate a new one
-    if (bitcount < bits)
+    int i;
+    psrand_seed(ARTISANAL_NUMBER);
+    for (i = 0; i < PSEUDO_VALUES; i++)
     {
-        cur_rand = psrand_next();
-        bitcount = 32;
+        random_seeds[i] = psrand_next();
     }
-
-    out = cur_rand & ((1 << (bits)) - 1); // Extract the requested number of bits
-    cur_rand = cur_rand >> bits;          // Shift `cur_rand` for next extraction
-    bitcount -= bits;                     // Decrement available bit count
-    return out;
 }
 
 /**
- * @brief Executes a pseudo-random data test on the RAM chip.
- *
- * Writes a sequence of pseudo-random data to memory, then reads it back
- * and verifies its integrity. This process is repeated with different seeds.
+ * @brief Times a write pass and a read pass over the whole chip with one backend.
  *
  * @param addr_size The total number of addresses in the RAM chip.
- * @param bits The number of data bits in the RAM chip.
- * @return 0 if the test passes, 1 if a mismatch is found.
+ * @param transport The block transfer backend to measure.
+ * @return Throughput in thousands of accesses per second.
  */
-static uint32_t psrandom_test(uint32_t addr_size, uint32_t bits)
+static uint32_t measure_transport(uint32_t addr_size, ram_transport_t transport)
 {
-    uint i;
-    uint32_t bitsout;                  // Data written to RAM
-    uint32_t bitsin;                   // Data read from RAM
-    uint32_t bitshift = addr_size / 4; // This variable is declared but not used.
-
-    // Iterate through pre-generated random seeds
-    for (i = 0; i < PSEUDO_VALUES; i++)
+    ram_transport_t saved = ram_transport;
+    uint64_t start;
+    uint64_t elapsed;
+    uint32_t addr;
+    uint32_t n;
+
+    ram_transport = transport;
+    for (n = 0; n < RAM_BLOCK_SIZE; n++)
+        ram_block_out[n] = 0;
+
+    start = time_us_64();
+    for (addr = 0; addr < addr_size; addr += n)
     {
-        stat_cur_subtest = i >> 2;    // Update subtest for UI visualization
-        stat_cur_bit = i & 3;         // Update current bit for UI visualization
-        psrand_seed(random_seeds[i]); // Seed the generator with a stored seed
-
-        // Write seeded pseudo-random data to all addresses
-        for (stat_cur_addr = 0; stat_cur_addr < addr_size; stat_cur_addr++)
-        {
-            bitsout = psrand_next_bits(bits);
-            ram_write(stat_cur_addr, bitsout);
-        }
-
-        // Reseed with the same seed and then read the data back for verification
-        psrand_seed(random_seeds[i]);
-        for (stat_cur_addr = 0; stat_cur_addr < addr_size; stat_cur_addr++)
-        {
-            bitsout = psrand_next_bits(bits);
-            bitsin = ram_read(stat_cur_addr);
-            if (bitsout != bitsin)
-            {
-                return 1; // Return 1 on first mismatch (failure)
-            }
-        }
+        n = MIN(RAM_BLOCK_SIZE, addr_size - addr);
+        ram_write_block(addr, ram_block_out, n);
+    }
+    for (addr = 0; addr < addr_size; addr += n)
+    {
+        n = MIN(RAM_BLOCK_SIZE, addr_size - addr);
+        ram_read_block(addr, ram_block_in, n);
     }
+    elapsed = time_us_64() - start;
 
-    return 0; // Test passed
+    ram_transport = saved;
+    return (uint32_t)((2ULL * addr_size * 1000) / MAX(elapsed, 1));
 }
 
 /**
- * @brief Executes a refresh subtest for the RAM chip.
+ * @brief Picks the faster block transfer backend for the selected chip and speed grade.
  *
- * Writes pseudo-random data to memory, waits for a specified `time_delay`
- * (simulating refresh interval), then reads back and verifies the data.
+ * Both backends are timed over the whole chip the first time a chip and
+ * grade are tested, and the choice is kept for later runs of the same one,
+ * so it costs four passes once rather than on every run and does not
+ * change between runs on timing noise. CRC verification forces DMA.
  *
  * @param addr_size The total number of addresses in the RAM chip.
- * @param bits The number of data bits in the RAM chip.
- * @param time_delay The delay in microseconds to simulate refresh interval.
- * @return 0 if the test passes, 1 if a mismatch is found.
  */
-static uint32_t refresh_subtest(uint32_t addr_size, uint32_t bits, uint32_t time_delay)
+static void select_transport(uint32_t addr_size)
 {
-    uint32_t bitsout;
-    uint32_t bitsin;
+    static int measured_chip = -1;
+    static int measured_grade = -1;
 
-    psrand_seed(random_seeds[0]); // Use the first pre-generated seed
-    // Write pseudo-random data to all addresses
-    for (stat_cur_addr = 0; stat_cur_addr < addr_size; stat_cur_addr++)
+    if ((measured_chip != main_menu.sel_line) || (measured_grade != speed_menu.sel_line))
     {
-        bitsout = psrand_next_bits(bits);
-        ram_write(stat_cur_addr, bitsout); // Note: This writes 'bits' value, not 'bitsout'. This might be a bug or intentional.
+        ram_polled_kaps = measure_transport(addr_size, RAM_TRANSPORT_POLLED);
+        ram_dma_kaps = measure_transport(addr_size, RAM_TRANSPORT_DMA);
+        measured_chip = main_menu.sel_line;
+        measured_grade = speed_menu.sel_line;
     }
+    // CRC verification needs the DMA sniffer, so it always runs over DMA
+    if (crc_verify_mode || (ram_dma_kaps > ram_polled_kaps))
+        ram_transport = RAM_TRANSPORT_DMA;
+    else
+        ram_transport = RAM_TRANSPORT_POLLED;
+}
 
-    sleep_us(time_delay); // Wait for the specified delay
-
-    psrand_seed(random_seeds[0]); // Reseed with the same seed
-    // Read back and verify data
-    for (stat_cur_addr = 0; stat_cur_addr < addr_size; stat_cur_addr++)
-    {
-        bitsout = psrand_next_bits(bits);
-        bitsin = ram_read(stat_cur_addr);
-        if (bitsout != bitsin)
-        {             // Note: This compares 'bits' with 'bitsin', not 'bitsout'. This might be a bug or intentional.
-            return 1; // Return 1 on first mismatch (failure)
-        }
-    }
-    return 0; // Test passed
+/**
+ * @brief Starts one of the tests run by `all_ram_tests`.
+ *
+ * @param test Index of the test in `ram_test_names`.
+ */
+static void begin_test(int test)
+{
+    queue_add_blocking(&stat_cur_test, &test); // Update UI with current test
+    failure_map_set_test(test);
+    if (ROW_AGE_TRACKING)
+        row_age_start(chip_list[main_menu.sel_line]->row_bits);
 }
 
 /**
- * @brief Executes the refresh test for the RAM chip.
+ * @brief Finishes one of the tests run by `all_ram_tests`.
  *
- * Calls `refresh_subtest` with a default delay of 5000 microseconds.
+ * Records the worst row age of the test when row age tracking is built in.
  *
- * @param addr_size The total number of addresses in the RAM chip.
- * @param bits The number of data bits in the RAM chip.
- * @return 0 if the test passes, 1 if a mismatch is found.
+ * @param test Index of the test in `ram_test_names`.
  */
-static uint32_t refresh_test(uint32_t addr_size, uint32_t bits)
+static void end_test(int test)
 {
-    return refresh_subtest(addr_size, bits, 5000); // 5000 us delay for refresh test
+    if (ROW_AGE_TRACKING)
+        row_age_worst_us[test] = row_age_finish(ram_refresh_period_us(chip_list[main_menu.sel_line]),
+                                                &row_age_violations[test]);
 }
 
 /**
- * @brief Executes the Checkerboard test on the RAM chip.
+ * @brief Executes all defined RAM tests in sequence.
  *
- * Writes alternating patterns (0x5555... and 0xAAAA...) to memory,
- * then reads back and verifies the data.
+ * Runs the tests of the selected test profile, to its depth. It updates the
+ * UI with the current test being executed and returns the first failure
+ * encountered.
+ * In failure map mode every test runs to completion, each failing cell is
+ * recorded in the failure map and the map is summarized into `failure_summary`.
  *
  * @param addr_size The total number of addresses in the RAM chip.
  * @param bits The number of data bits in the RAM chip.
- * @return 0 if the test passes, 1 if a mismatch is found.
+ * @return 0 if all tests pass, otherwise a non-zero value indicating failure.
  */
-static uint32_t checkerboard_test(uint32_t addr_size, uint32_t bits)
+uint32_t all_ram_tests(uint32_t addr_size, uint32_t bits)
 {
-    uint32_t pattern1 = 0x55555555 & ((1ULL << bits) - 1);
-    uint32_t pattern2 = 0xAAAAAAAA & ((1ULL << bits) - 1);
-    uint32_t bitsin;
+    const test_profile_t *profile = &test_profiles[test_profile];
+    uint32_t failed = 0;
+    uint32_t i;
 
-    for (int loop = 0; loop < 10; loop++)
+    select_transport(addr_size);
+    failure_map_clear();
+    golden_mismatch_cells = 0;
+    for (i = 0; i < NUM_RAM_TESTS; i++)
     {
-        // Write pattern1
-        stat_cur_subtest = 0;
-        for (stat_cur_addr = 0; stat_cur_addr < addr_size; stat_cur_addr++) {
-            for (int bit = 0; bit < bits; bit++) {
-                stat_cur_bit = bit; // Update for visualization
-                // Optionally, call a visualization update function here if needed
-            }
-            ram_write(stat_cur_addr, pattern1);
-        }
+        row_age_worst_us[i] = 0; // Tests that do not run report no age
+        row_age_violations[i] = 0;
+    }
+    // Keep every row refreshed between test accesses until the test is stopped
+    ram_refresh_start(chip_list[main_menu.sel_line]);
 
-        // Read and check pattern1
-        stat_cur_subtest = 1;
-        for (stat_cur_addr = 0; stat_cur_addr < addr_size; stat_cur_addr++) {
-            bitsin = ram_read(stat_cur_addr);
-            for (int bit = 0; bit < bits; bit++) {
-                stat_cur_bit = bit; // Update for visualization
-                // Optionally, call a visualization update function here if needed
-            }
-            if (bitsin != pattern1)
-                return 1;
-        }
+    // March Test
+    if (profile->tests & 0x01)
+    {
+        march_set_background(0, (1ULL << bits) - 1);
+        march_element(addr_size, &march_algorithms[march_algorithm].elements[0]); // Initialize memory
+        begin_test(0);
+        failed |= march_test(addr_size, bits, &march_algorithms[march_algorithm]);
+        end_test(0);
+        if (failed && !failure_map_mode)
+            return failed;
+    }
 
-        // Write pattern2
-        stat_cur_subtest = 2;
-        for (stat_cur_addr = 0; stat_cur_addr < addr_size; stat_cur_addr++) {
-            for (int bit = 0; bit < bits; bit++) {
-                stat_cur_bit = bit; // Update for visualization
-            }
-            ram_write(stat_cur_addr, pattern2);
-        }
+    // Pseudo-random Test
+    if (profile->tests & 0x02)
+    {
+        begin_test(1);
+        failed |= psrandom_test(addr_size, bits);
+        end_test(1);
+        if (failed && !failure_map_mode)
+            return failed;
+    }
 
-        // Read and check pattern2
-        stat_cur_subtest = 3;
-        for (stat_cur_addr = 0; stat_cur_addr < addr_size; stat_cur_addr++) {
-            bitsin = ram_read(stat_cur_addr);
-            for (int bit = 0; bit < bits; bit++) {
-                stat_cur_bit = bit; // Update for visualization
-            }
-            if (bitsin != pattern2)
-                return 1;
-        }
+    // Refresh Test
+    if (profile->tests & 0x04)
+    {
+        begin_test(2);
+        failed |= refresh_test(addr_size, bits);
+        end_test(2);
+        if (failed && !failure_map_mode)
+            return failed;
+    }
+
+    // Checkerboard Test
+    if (profile->tests & 0x08)
+    {
+        begin_test(3);
+        failed |= checkerboard_test(addr_size, bits);
+        end_test(3);
+        if (failed && !failure_map_mode)
+            return failed;
+    }
+
+    // Address-in-Address Test
+    if (profile->tests & 0x10)
+    {
+        begin_test(4);
+        failed |= address_in_address_test(addr_size, bits);
+        end_test(4);
     }
-    return 0;
+
+    if (failure_map_mode)
+        failure_map_summarize(addr_size, chip_list[main_menu.sel_line]->row_bits, &failure_summary);
+
+    return failed; // 0 if all tests passed
 }
 
+// Static Helper Functions (March engine and related operations)
 
 /**
- * @brief Helper function to reverse bits in a number.
+ * @brief Sets the data the March elements write and check.
  *
- * @param num The number to reverse.
- * @param num_bits The number of bits to consider.
- * @return The bit-reversed number.
+ * A logical 0 writes `d0` and a logical 1 writes its complement. Reads
+ * compare only the bits in `mask`.
+ *
+ * @param d0 The data word written for a logical 0.
+ * @param mask Data bits compared on each read.
  */
-static uint32_t bit_reverse(uint32_t num, uint32_t num_bits)
+static void march_set_background(uint32_t d0, uint32_t mask)
 {
-    uint32_t result = 0;
-    for (uint32_t i = 0; i < num_bits; i++) {
-        if (num & (1ULL << i)) {
-            result |= (1ULL << (num_bits - 1 - i));
-        }
-    }
-    return result;
+    march_d0 = d0;
+    march_d1 = ~d0;
+    march_e0 = d0 & mask;
+    march_e1 = ~d0 & mask;
+    march_mask = mask;
 }
 
 /**
- * @brief Address-in-Address test with comprehensive address line testing.
+ * @brief Resolves a March element's ops against the current data background.
  *
- * This performs multiple passes with different addressing patterns
- * to catch more subtle address line faults:
- * - Normal address sequence (0, 1, 2, 3, ...)
- * - Reverse address sequence (max, max-1, max-2, ...)  
- * - Bit-reversed address sequence
- * - Powers-of-2 address sequence (1, 2, 4, 8, 16, ...)
+ * Each op becomes a write flag, a data word and an expected read value, so
+ * the address loop can issue them without decoding the op.
  *
- * @param addr_size The total number of addresses in the RAM chip.
- * @param bits The number of data bits in the RAM chip.
- * @return 0 if all tests pass, bitmask indicating which bits failed.
+ * @param e The March element.
+ * @param c The compiled element.
  */
-static uint32_t address_in_address_test(uint32_t addr_size, uint32_t bits)
+static void march_compile_element(const march_element_t *e, march_compiled_t *c)
 {
-    uint32_t failed = 0;
-    uint32_t addr, expected_data, actual_data;
-    uint32_t addr_mask;
+    uint8_t k;
 
-    // Calculate testable address bits and mask
-    uint32_t testable_addr_bits = (bits < 32) ? bits : 32;
-    addr_mask = (1ULL << testable_addr_bits) - 1;
-
-    // Test patterns: 0=normal, 1=reverse, 2=bit-reversed, 3=powers-of-2
-    for (uint32_t pattern = 0; pattern < 4; pattern++)
+    c->num_ops = e->num_ops;
+    for (k = 0; k < e->num_ops; k++)
     {
-        // Test each data bit individually  
-        for (uint32_t bit = 0; bit < bits; bit++)
+        switch (e->ops[k])
         {
-            stat_cur_bit = bit;          
-            ram_bit_mask = 1ULL << bit;  
-            stat_cur_subtest = pattern;  // Update UI with current test pattern
+        case MARCH_R0:
+            c->write[k] = false;
+            c->data[k] = 0;
+            c->expect[k] = march_e0;
+            break;
+        case MARCH_R1:
+            c->write[k] = false;
+            c->data[k] = 0;
+            c->expect[k] = march_e1;
+            break;
+        case MARCH_W0:
+            c->write[k] = true;
+            c->data[k] = march_d0;
+            c->expect[k] = RAM_STREAM_NO_CHECK;
+            break;
+        case MARCH_W1:
+            c->write[k] = true;
+            c->data[k] = march_d1;
+            c->expect[k] = RAM_STREAM_NO_CHECK;
+            break;
+        }
+    }
+}
 
-            // Write phase
-            for (uint32_t i = 0; i < addr_size; i++)
-            {
-                // Calculate actual address based on pattern
-                switch (pattern) {
-                    case 0: // Normal sequence
-                        addr = i;
-                        break;
-                    case 1: // Reverse sequence  
-                        addr = (addr_size - 1) - i;
-                        break;
-                    case 2: // Bit-reversed sequence
-                        addr = bit_reverse(i, testable_addr_bits);
-                        break;
-                    case 3: // Powers of 2 (cycling)
-                        addr = 1ULL << (i % testable_addr_bits);
-                        break;
-                }
+/**
+ * @brief Executes a single March test element.
+ *
+ * Iterates through memory addresses in the element's order and applies its
+ * ops to each one. Operations are streamed to the state machine and their
+ * reads checked as results come back, so a failure is noticed a few
+ * operations after it happens. Publishes progress every PROGRESS_INTERVAL addresses.
+ *
+ * @param addr_size The total number of addresses to test.
+ * @param e The March element to execute.
+ * @return True if all operations in the element pass, false otherwise.
+ */
+static bool march_element(int addr_size, const march_element_t *e)
+{
+    bool descending = (e->order == MARCH_DOWN);
+    int inc = descending ? -1 : 1;                // Increment/decrement step
+    int start = descending ? (addr_size - 1) : 0; // Starting address
+    int end = descending ? -1 : addr_size;        // Ending condition
+    march_compiled_t c;
+    uint8_t k;
+    int a;
+
+    march_compile_element(e, &c);
+    ram_check_stream_init(&test_stream, march_mask, map_fail_fn());
+
+    for (a = start; a != end; a += inc)
+    {
+        if ((a & (PROGRESS_INTERVAL - 1)) == 0)
+            progress_at(a);
+        if (ram_refresh_due())
+        {
+            ram_check_stream_finish(&test_stream); // Empty the pipeline first
+            ram_refresh_catch_up();
+        }
+        for (k = 0; k < c.num_ops; k++)
+        {
+            ram_check_stream_issue(&test_stream, a, ram_encode(a, c.data[k], c.write[k]), c.expect[k]);
+        }
+        if (test_stream.failures && !failure_map_mode)
+            break; // Stop early once a failure has been seen
+    }
+    return ram_check_stream_finish(&test_stream);
+}
+
+/**
+ * @brief Executes every element of a March algorithm with the current background.
+ *
+ * Stops at the first failing element unless every failure is being mapped.
+ *
+ * @param addr_size The total number of addresses in the RAM chip.
+ * @param alg The March algorithm.
+ * @return A bitmask of the data bits that read back wrong, 0 if the algorithm passes.
+ */
+static uint32_t march_run(uint32_t addr_size, const march_algorithm_t *alg)
+{
+    uint32_t failed = 0;
+    uint8_t i;
+
+    for (i = 0; i < alg->num_elements; i++)
+    {
+        progress.subtest = MIN(i, 4); // Update current element for UI visualization
+        if (!march_element(addr_size, &alg->elements[i]))
+        {
+            failed |= test_stream.fail_bits;
+            if (!failure_map_mode)
+                break;
+        }
+    }
+    return failed;
+}
+
+/**
+ * @brief Executes a March test for all data bits of the RAM chip.
+ *
+ * Tests every DQ line at once, running the March once per data background
+ * rather than once per bit. A 4-bit part needs 3 passes instead of 4 and
+ * still has intra-word coupling between each pair of bits exercised.
+ *
+ * @param addr_size The total number of addresses in the RAM chip.
+ * @param bits The number of data bits in the RAM chip.
+ * @param alg The March algorithm to run.
+ * @return A bitmask where each set bit indicates a failure in the corresponding data bit.
+ */
+static uint32_t march_test(uint32_t addr_size, uint32_t bits, const march_algorithm_t *alg)
+{
+    uint32_t word_mask = (1ULL << bits) - 1;
+    uint32_t failed = 0;
+    uint32_t bg;
+
+    ram_bit_mask = word_mask;
+    // 1 + log2(bits) backgrounds
+    for (bg = 0; (bg < count_of(march_backgrounds)) && ((1u << bg) <= bits); bg++)
+    {
+        progress.bit = bg; // Update current background for UI visualization
+        march_set_background(march_backgrounds[bg] & word_mask, word_mask);
+        failed |= march_run(addr_size, alg); // Bits that read back wrong
+    }
+
+    return failed;
+}
+
+/**
+ * @brief Generates the next `bits` number of pseudo-random bits.
+ *
+ * Uses the `xoroshiro64starstar` generator to produce 32-bit random numbers
+ * and extracts the requested number of bits from it.
+ *
+ * @param bits The number of bits to generate (1 to 32).
+ * @return A `uint32_t` containing the generated pseudo-random bits.
+ */
+static uint32_t psrand_next_bits(uint32_t bits)
+{
+    static int bitcount = 0;  // Number of remaining bits in current `cur_rand`
+    static uint32_t cur_rand; // Current 32-bit random number
+    uint32_t out;
+
+    // If not enough bits left in `cur_rand`, generate a new one
+    if (bitcount < bits)
+    {
+        cur_rand = psrand_next();
+        bitcount = 32;
+    }
+
+    out = cur_rand & ((1 << (bits)) - 1); // Extract the requested number of bits
+    cur_rand = cur_rand >> bits;          // Shift `cur_rand` for next extraction
+    bitcount -= bits;                     // Decrement available bit count
+    return out;
+}
+
+/**
+ * @brief Writes one seed's pseudo-random data to the whole chip, double buffered.
+ *
+ * Memory is walked row by row in page bursts. Each block of command words is
+ * built while the previous one streams to the state machine by DMA. With
+ * `crcs` given, the CRC32 of each block is also taken while the bus is busy.
+ *
+ * @param addr_size The total number of addresses in the RAM chip.
+ * @param bits The number of data bits in the RAM chip.
+ * @param crcs Buffer receiving one CRC32 per block, or NULL.
+ */
+static void psrandom_write_pipelined(uint32_t addr_size, uint32_t bits, uint32_t *crcs)
+{
+    const mem_chip_t *chip = chip_list[main_menu.sel_line];
+    uint32_t cols = addr_size >> chip->row_bits;
+    uint32_t pos;
+    uint32_t n;
+    uint32_t j;
+    uint32_t k = 0;
+    int addr;
+    int cur = 0;
+
+    for (pos = 0; pos < addr_size; pos += n, k++)
+    {
+        n = MIN(RAM_BLOCK_SIZE, cols - (pos % cols)); // Never cross into the next row
+        addr = (pos / cols) | ((pos % cols) << chip->row_bits);
+        progress_at(pos); // Progress through the pass
+
+        for (j = 0; j < n; j++)
+        {
+            psrand_expect[cur][j] = psrand_next_bits(bits);
+        }
+        encode_run(psrand_cmds[cur], addr, 1 << chip->row_bits, psrand_expect[cur], n, chip->page_mode);
+        if (crcs)
+            crcs[k] = ram_dma_crc(psrand_expect[cur], n, true);
+
+        if (pos)
+            ram_dma_wait(); // The other buffer must finish before this one starts
+        ram_refresh_service(); // Nothing is in flight here
+        row_age_touch(addr);
+        ram_dma_start(psrand_cmds[cur], NULL, n);
+        cur ^= 1;
+    }
+    ram_dma_wait();
+}
+
+/**
+ * @brief Reads one seed's pseudo-random data back from the whole chip, double buffered.
+ *
+ * While a block streams in, the previous block's results are compared
+ * against the regenerated data and the next block's commands are built.
+ *
+ * @param addr_size The total number of addresses in the RAM chip.
+ * @param bits The number of data bits in the RAM chip.
+ * @return 0 if all data matched, 1 on the first mismatching block (or at the
+ *         end of the pass when mapping every failure).
+ */
+static uint32_t psrandom_verify_pipelined(uint32_t addr_size, uint32_t bits)
+{
+    const mem_chip_t *chip = chip_list[main_menu.sel_line];
+    uint32_t cols = addr_size >> chip->row_bits;
+    uint32_t pos;
+    uint32_t n;
+    uint32_t prev_n = 0;
+    uint32_t failed = 0;
+    uint32_t j;
+    int prev_addr = 0;
+    int addr;
+    int cur = 0;
+
+    for (pos = 0; pos < addr_size; pos += n)
+    {
+        n = MIN(RAM_BLOCK_SIZE, cols - (pos % cols));
+        addr = (pos / cols) | ((pos % cols) << chip->row_bits);
+        progress_at(pos);
+
+        for (j = 0; j < n; j++)
+        {
+            psrand_expect[cur][j] = psrand_next_bits(bits);
+        }
+        encode_run(psrand_cmds[cur], addr, 1 << chip->row_bits, NULL, n, chip->page_mode);
+
+        if (pos)
+            ram_dma_wait();
+        ram_refresh_service();
+        row_age_touch(addr);
+        ram_dma_start(psrand_cmds[cur], psrand_results[cur], n);
+
+        // Check the previous block while this one is on the bus
+        failed |= check_block(prev_addr, 1 << chip->row_bits, psrand_expect[cur ^ 1], psrand_results[cur ^ 1], prev_n);
+        if (failed && !failure_map_mode)
+        {
+            ram_dma_wait();
+            return 1;
+        }
+        prev_addr = addr;
+        prev_n = n;
+        cur ^= 1;
+    }
+    ram_dma_wait();
+
+    failed |= check_block(prev_addr, 1 << chip->row_bits, psrand_expect[cur ^ 1], psrand_results[cur ^ 1], prev_n);
+    return failed ? 1 : 0;
+}
+
+/**
+ * @brief Writes the generator's next values to the whole chip, a row at a time.
+ *
+ * @param addr_size The total number of addresses in the RAM chip.
+ * @param bits The number of data bits in the RAM chip.
+ */
+static void psrandom_write_rows(uint32_t addr_size, uint32_t bits)
+{
+    uint32_t row_bits = chip_list[main_menu.sel_line]->row_bits;
+    uint32_t rows = 1 << row_bits;
+    uint32_t cols = addr_size >> row_bits;
+    uint32_t row;
+    uint32_t col;
+    uint32_t n;
+    uint32_t j;
+
+    for (row = 0; row < rows; row++)
+    {
+        for (col = 0; col < cols; col += n)
+        {
+            n = MIN(RAM_BLOCK_SIZE, cols - col);
+            progress_at(row * cols + col); // Progress through the pass
+            for (j = 0; j < n; j++)
+            {
+                ram_block_out[j] = psrand_next_bits(bits);
+            }
+            ram_write_page(row | (col << row_bits), ram_block_out, n);
+        }
+    }
+}
+
+/**
+ * @brief Reads the whole chip back a row at a time against the generator's next values.
+ *
+ * @param addr_size The total number of addresses in the RAM chip.
+ * @param bits The number of data bits in the RAM chip.
+ * @return 0 if all data matched, 1 otherwise.
+ */
+static uint32_t psrandom_verify_rows(uint32_t addr_size, uint32_t bits)
+{
+    uint32_t row_bits = chip_list[main_menu.sel_line]->row_bits;
+    uint32_t rows = 1 << row_bits;
+    uint32_t cols = addr_size >> row_bits;
+    uint32_t row;
+    uint32_t col;
+    uint32_t n;
+    uint32_t j;
+    bool failed = false;
+
+    for (row = 0; row < rows; row++)
+    {
+        for (col = 0; col < cols; col += n)
+        {
+            n = MIN(RAM_BLOCK_SIZE, cols - col);
+            progress_at(row * cols + col);
+            ram_read_page(row | (col << row_bits), ram_block_in, n);
+            for (j = 0; j < n; j++)
+            {
+                ram_block_out[j] = psrand_next_bits(bits);
+            }
+            failed |= check_block(row | (col << row_bits), 1 << row_bits, ram_block_out, ram_block_in, n);
+            if (failed && !failure_map_mode)
+                return 1;
+        }
+    }
+    return failed ? 1 : 0;
+}
+
+/**
+ * @brief Reads one seed's pseudo-random data back with core0 doing the compare.
+ *
+ * Core1 only issues reads, straight into the slots of the SPSC ring, and
+ * core0 checks each block against its own copy of the seeded stream. The
+ * next burst goes out while core0 is still comparing the last one.
+ *
+ * @param addr_size The total number of addresses in the RAM chip.
+ * @param bits The number of data bits in the RAM chip.
+ * @param seed The seed the data was written with.
+ * @return 0 if all data matched, 1 otherwise.
+ */
+static uint32_t psrandom_verify_split(uint32_t addr_size, uint32_t bits, uint64_t seed)
+{
+    uint32_t row_bits = chip_list[main_menu.sel_line]->row_bits;
+    uint32_t rows = 1 << row_bits;
+    uint32_t cols = addr_size >> row_bits;
+    split_block_t *b;
+    uint32_t row;
+    uint32_t col;
+    uint32_t n;
+
+    split_verify_begin(seed, bits);
+    for (row = 0; row < rows; row++)
+    {
+        for (col = 0; col < cols; col += n)
+        {
+            n = MIN(RAM_BLOCK_SIZE, cols - col);
+            progress_at(row * cols + col);
+            b = split_ring_claim();
+            b->addr = row | (col << row_bits);
+            b->stride = 1 << row_bits;
+            b->count = n;
+            ram_read_page(b->addr, b->data, n);
+            split_ring_publish();
+        }
+        if (split_verify_failures() && !failure_map_mode)
+            break; // Core0 has already seen a failure
+    }
+    return split_verify_end() ? 1 : 0;
+}
+
+/**
+ * @brief Reads one seed's pseudo-random data back and checks it by CRC.
+ *
+ * The results of each block only pass through the DMA sniffer, and the CPU
+ * compares one CRC per block against the one taken when it was written. In
+ * failure map mode the blocks that mismatched are read again afterwards
+ * and compared address by address to find the failing cells.
+ *
+ * @param addr_size The total number of addresses in the RAM chip.
+ * @param bits The number of data bits in the RAM chip.
+ * @param seed The seed the data was written with.
+ * @return 0 if every block matched, 1 otherwise.
+ */
+static uint32_t psrandom_verify_crc(uint32_t addr_size, uint32_t bits, uint64_t seed)
+{
+    const mem_chip_t *chip = chip_list[main_menu.sel_line];
+    uint32_t cols = addr_size >> chip->row_bits;
+    uint32_t failed = 0;
+    uint32_t pos;
+    uint32_t n;
+    uint32_t j;
+    uint32_t k;
+    int addr;
+    int cur = 0;
+
+    for (k = 0; k < PSRAND_CRC_BLOCKS / 32; k++)
+        psrand_crc_bad[k] = 0;
+
+    for (pos = 0, k = 0; pos < addr_size; pos += n, k++)
+    {
+        n = MIN(RAM_BLOCK_SIZE, cols - (pos % cols));
+        addr = (pos / cols) | ((pos % cols) << chip->row_bits);
+        progress_at(pos);
+        encode_run(psrand_cmds[cur], addr, 1 << chip->row_bits, NULL, n, chip->page_mode);
+
+        if (pos)
+        {
+            ram_dma_wait();
+            if (ram_dma_sniffed_crc() != psrand_crc[k - 1])
+            {
+                failed = 1;
+                psrand_crc_bad[(k - 1) / 32] |= 1u << ((k - 1) % 32);
+                if (!failure_map_mode)
+                    return 1;
+            }
+        }
+        ram_refresh_service();
+        row_age_touch(addr);
+        ram_dma_start_sniffed(psrand_cmds[cur], n);
+        cur ^= 1;
+    }
+    ram_dma_wait();
+    if (ram_dma_sniffed_crc() != psrand_crc[k - 1])
+    {
+        failed = 1;
+        psrand_crc_bad[(k - 1) / 32] |= 1u << ((k - 1) % 32);
+    }
+
+    if (failed && failure_map_mode)
+    {
+        // Replay the bad blocks, regenerating the stream to get their data
+        psrand_seed(seed);
+        for (pos = 0, k = 0; pos < addr_size; pos += n, k++)
+        {
+            n = MIN(RAM_BLOCK_SIZE, cols - (pos % cols));
+            for (j = 0; j < n; j++)
+            {
+                ram_block_out[j] = psrand_next_bits(bits);
+            }
+            if (psrand_crc_bad[k / 32] & (1u << (k % 32)))
+            {
+                addr = (pos / cols) | ((pos % cols) << chip->row_bits);
+                ram_read_page(addr, ram_block_in, n);
+                check_block(addr, 1 << chip->row_bits, ram_block_out, ram_block_in, n);
+            }
+        }
+    }
+    return failed;
+}
+
+#if GOLDEN_IMAGE_COMPARE
+/**
+ * @brief Generates the pseudo-random image for the current seed into `golden_image`.
+ *
+ * Cells are packed `bits` at a time, in the order of the row-major walk.
+ *
+ * @param addr_size The total number of addresses in the RAM chip.
+ * @param bits The number of data bits in the RAM chip.
+ */
+static void golden_fill_psrand(uint32_t addr_size, uint32_t bits)
+{
+    uint32_t words = addr_size * bits / 32;
+    uint32_t w;
+    uint32_t sh;
+    uint32_t v;
+
+    for (w = 0; w < words; w++)
+    {
+        v = 0;
+        for (sh = 0; sh < 32; sh += bits)
+        {
+            v |= psrand_next_bits(bits) << sh;
+        }
+        golden_image[w] = v;
+    }
+}
+
+/**
+ * @brief Writes `golden_image` to the chip a row at a time.
+ *
+ * @param addr_size The total number of addresses in the RAM chip.
+ * @param bits The number of data bits in the RAM chip.
+ */
+static void golden_write(uint32_t addr_size, uint32_t bits)
+{
+    const mem_chip_t *chip = chip_list[main_menu.sel_line];
+    uint32_t cols = addr_size >> chip->row_bits;
+    uint32_t cell_mask = (1 << bits) - 1;
+    uint32_t pos;
+    uint32_t n;
+    uint32_t j;
+    uint32_t b;
+
+    for (pos = 0; pos < addr_size; pos += n)
+    {
+        n = MIN(RAM_BLOCK_SIZE, cols - (pos % cols));
+        progress_at(pos);
+        for (j = 0; j < n; j++)
+        {
+            b = (pos + j) * bits;
+            ram_block_out[j] = (golden_image[b / 32] >> (b % 32)) & cell_mask;
+        }
+        ram_write_page((pos / cols) | ((pos % cols) << chip->row_bits), ram_block_out, n);
+    }
+}
+
+/**
+ * @brief Counts the cells with at least one bad bit in a word of XORed data.
+ *
+ * @param x Read-back data XOR expected data, `32 / bits` cells.
+ * @param bits The number of data bits per cell (1 or 4).
+ * @return The number of mismatched cells.
+ */
+static inline uint32_t golden_bad_cells(uint32_t x, uint32_t bits)
+{
+    if (bits == 4)
+    {
+        // Fold each nibble onto its low bit
+        x |= x >> 1;
+        x |= x >> 2;
+        x &= 0x11111111;
+    }
+    return __builtin_popcount(x);
+}
+
+/**
+ * @brief Reads the chip back and compares it with `golden_image`, 32 bits at a time.
+ *
+ * Each block of read-back data is packed like the image, then XORed with
+ * it. Every mismatched cell is counted rather than stopping at the first,
+ * and added to `golden_mismatch_cells`.
+ *
+ * @param addr_size The total number of addresses in the RAM chip.
+ * @param bits The number of data bits in the RAM chip.
+ * @return The number of mismatched cells.
+ */
+static uint32_t golden_verify(uint32_t addr_size, uint32_t bits)
+{
+    const mem_chip_t *chip = chip_list[main_menu.sel_line];
+    uint32_t cols = addr_size >> chip->row_bits;
+    uint32_t cell_mask = (1 << bits) - 1;
+    uint32_t bad = 0;
+    uint32_t pos;
+    uint32_t n;
+    uint32_t j;
+    uint32_t stride = 1 << chip->row_bits;
+    uint32_t addr;
+    uint32_t w;
+    uint32_t b;
+    uint32_t x;
+
+    for (pos = 0; pos < addr_size; pos += n)
+    {
+        n = MIN(RAM_BLOCK_SIZE, cols - (pos % cols));
+        addr = (pos / cols) | ((pos % cols) << chip->row_bits);
+        progress_at(pos);
+        ram_read_page(addr, ram_block_in, n);
+
+        // Blocks always start and end on a word boundary of the image
+        for (w = 0; w < n * bits / 32; w++)
+            golden_block[w] = 0;
+        for (j = 0; j < n; j++)
+        {
+            b = j * bits;
+            golden_block[b / 32] |= (ram_block_in[j] & cell_mask) << (b % 32);
+        }
+        for (w = 0; w < n * bits / 32; w++)
+        {
+            x = golden_block[w] ^ golden_image[pos * bits / 32 + w];
+            bad += golden_bad_cells(x, bits);
+            if (x && failure_map_mode)
+            {
+                // Only the rare bad words are walked cell by cell
+                for (b = 0; b < 32; b += bits)
+                {
+                    if ((x >> b) & cell_mask)
+                        failure_map_record(addr + ((w * 32 + b) / bits) * stride, (x >> b) & cell_mask);
+                }
+            }
+        }
+    }
+    golden_mismatch_cells += bad;
+    return bad;
+}
+#endif
+
+/**
+ * @brief Executes a pseudo-random data test on the RAM chip.
+ *
+ * Writes a sequence of pseudo-random data to memory, then reads it back
+ * and verifies its integrity. This process is repeated with as many seeds
+ * as the test profile asks for. Memory is walked row by row so each row is opened once per page burst.
+ * With the DMA backend, command generation is double buffered against the
+ * transfers so the bus is kept busy.
+ * In split mode the compare runs on core0 instead, off the issue path, and
+ * in CRC mode it is replaced by one CRC compare per block.
+ *
+ * @param addr_size The total number of addresses in the RAM chip.
+ * @param bits The number of data bits in the RAM chip.
+ * @return 0 if the test passes, 1 if a mismatch is found.
+ */
+static uint32_t psrandom_test(uint32_t addr_size, uint32_t bits)
+{
+    uint i;
+    uint32_t failed = 0;
+
+    // Iterate through pre-generated random seeds
+    for (i = 0; i < test_profiles[test_profile].pseudo_seeds; i++)
+    {
+        progress.subtest = i >> 2;    // Update subtest for UI visualization
+        progress.bit = i & 3;         // Update current bit for UI visualization
+        psrand_seed(random_seeds[i]); // Seed the generator with a stored seed
+
+#if GOLDEN_IMAGE_COMPARE
+        golden_fill_psrand(addr_size, bits);
+        golden_write(addr_size, bits);
+        failed |= golden_verify(addr_size, bits) ? 1 : 0;
+#else
+        if (split_verify_mode)
+        {
+            psrandom_write_rows(addr_size, bits);
+            failed |= psrandom_verify_split(addr_size, bits, random_seeds[i]);
+        }
+        else if (crc_verify_mode)
+        {
+            psrandom_write_pipelined(addr_size, bits, psrand_crc);
+            failed |= psrandom_verify_crc(addr_size, bits, random_seeds[i]);
+        }
+        else if (ram_transport == RAM_TRANSPORT_DMA)
+        {
+            psrandom_write_pipelined(addr_size, bits, NULL);
+            psrand_seed(random_seeds[i]);
+            failed |= psrandom_verify_pipelined(addr_size, bits);
+        }
+        else
+        {
+            // Write seeded pseudo-random data to all addresses, a row at a time
+            psrandom_write_rows(addr_size, bits);
+
+            // Reseed with the same seed and then read the data back for verification
+            psrand_seed(random_seeds[i]);
+            failed |= psrandom_verify_rows(addr_size, bits);
+        }
+#endif
+        if (failed && !failure_map_mode)
+            return 1; // Return 1 on first mismatch (failure)
+    }
+
+    return failed ? 1 : 0; // 0 if the test passed
+}
+
+/**
+ * @brief Screens the whole chip with one seed of the pseudo-random test.
+ *
+ * @param addr_size The total number of addresses in the RAM chip.
+ * @param bits The number of data bits in the RAM chip.
+ * @param seed The seed of the data written and read back.
+ * @return 0 if all data matched, 1 otherwise.
+ */
+static uint32_t psrandom_screen(uint32_t addr_size, uint32_t bits, uint64_t seed)
+{
+    psrand_seed(seed);
+    psrandom_write_rows(addr_size, bits);
+    psrand_seed(seed);
+    return psrandom_verify_rows(addr_size, bits);
+}
+
+/**
+ * @brief Sweeps two PIO delay fields and screens the chip at every setting.
+ *
+ * Each of the SHMOO_STEPS x SHMOO_STEPS points patches the delays of
+ * `shmoo_field_x` and `shmoo_field_y` straight into the loaded program and
+ * runs one pass of the pseudo-random test. The other fields keep the
+ * selected speed grade's delays, which are restored at the end. Passing
+ * points are recorded in `shmoo_grid`, bit x of row y.
+ *
+ * @param addr_size The total number of addresses in the RAM chip.
+ * @param bits The number of data bits in the RAM chip.
+ * @return The number of points that failed.
+ */
+uint32_t shmoo_test(uint32_t addr_size, uint32_t bits)
+{
+    uint8_t base[32];
+    uint8_t delays[32];
+    uint8_t fields;
+    bool map_mode = failure_map_mode;
+    uint32_t failed = 0;
+    uint32_t x;
+    uint32_t y;
+
+    fields = pio_get_delays(base);
+    for (y = 0; y < SHMOO_STEPS; y++)
+        shmoo_grid[y] = 0;
+    if ((shmoo_field_x == 0) || (shmoo_field_x >= fields) ||
+        (shmoo_field_y == 0) || (shmoo_field_y >= fields))
+        return SHMOO_STEPS * SHMOO_STEPS; // The program has no such delay
+
+    failure_map_mode = false; // Only pass/fail matters at each point
+    ram_refresh_start(chip_list[main_menu.sel_line]);
+    for (y = 0; y < SHMOO_STEPS; y++)
+    {
+        for (x = 0; x < SHMOO_STEPS; x++)
+        {
+            memcpy(delays, base, sizeof(delays));
+            delays[shmoo_field_x] = x;
+            delays[shmoo_field_y] = y;
+            progress.subtest = y >> 3; // Sweep position for the UI visualization
+            progress.bit = (y >> 1) & 3;
+            pio_reload_delays(pio, sm, offset, delays, fields);
+            if (psrandom_screen(addr_size, bits, random_seeds[0]))
+                failed++;
+            else
+                shmoo_grid[y] |= 1u << x;
+        }
+    }
+    pio_reload_delays(pio, sm, offset, base, fields);
+    failure_map_mode = map_mode;
+
+    return failed;
+}
+
+/**
+ * @brief Screens the chip at one speed grade with every delay shortened.
+ *
+ * @param addr_size The total number of addresses in the RAM chip.
+ * @param bits The number of data bits in the RAM chip.
+ * @param grade The speed grade whose delays are loaded.
+ * @param shorten Cycles taken off every delay field, stopping at 0.
+ * @param passes Number of seeds that must all pass.
+ * @return True if every screen passed.
+ */
+static bool bin_screen(uint32_t addr_size, uint32_t bits, uint8_t grade, uint8_t shorten, uint8_t passes)
+{
+    const mem_chip_t *chip = chip_list[main_menu.sel_line];
+    uint8_t delays[32];
+    uint8_t i;
+
+    memcpy(delays, chip->delays[grade], sizeof(delays));
+    for (i = 1; i < chip->delay_fields; i++)
+        delays[i] = (delays[i] > shorten) ? delays[i] - shorten : 0;
+    pio_reload_delays(pio, sm, offset, delays, chip->delay_fields);
+
+    for (i = 0; i < passes; i++)
+    {
+        if (psrandom_screen(addr_size, bits, random_seeds[i]))
+            return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Finds the fastest speed grade the chip passes with margin.
+ *
+ * Walks the chip's delay table from the fastest grade towards the slowest.
+ * A grade is accepted when BIN_PASSES seeds of the pseudo-random screen all
+ * pass at its delays and still pass with every delay BIN_MIN_MARGIN cycles
+ * shorter. The margin is then measured by shortening the delays a cycle at
+ * a time, up to BIN_MAX_MARGIN. Results go to `bin_grade` and `bin_margin`.
+ *
+ * @param addr_size The total number of addresses in the RAM chip.
+ * @param bits The number of data bits in the RAM chip.
+ * @return 0 if a grade was found, 1 if even the slowest grade failed.
+ */
+uint32_t bin_test(uint32_t addr_size, uint32_t bits)
+{
+    const mem_chip_t *chip = chip_list[main_menu.sel_line];
+    uint8_t base[32];
+    uint8_t fields;
+    bool map_mode = failure_map_mode;
+    uint8_t grade;
+    uint8_t margin;
+
+    fields = pio_get_delays(base);
+    bin_grade = -1;
+    bin_margin = 0;
+    failure_map_mode = false; // Only pass/fail matters while binning
+    ram_refresh_start(chip);
+    for (grade = 0; grade < chip->speed_grades; grade++)
+    {
+        progress.subtest = MIN(grade, 4); // Grade under test for the UI visualization
+        progress.bit = 0;
+        if (!bin_screen(addr_size, bits, grade, 0, BIN_PASSES) ||
+            !bin_screen(addr_size, bits, grade, BIN_MIN_MARGIN, BIN_PASSES))
+            continue;
+
+        // Found it, so see how much further the delays can shrink
+        for (margin = BIN_MIN_MARGIN; margin < BIN_MAX_MARGIN; margin++)
+        {
+            if (!bin_screen(addr_size, bits, grade, margin + 1, 1))
+                break;
+        }
+        bin_grade = grade;
+        bin_margin = margin;
+        break;
+    }
+    pio_reload_delays(pio, sm, offset, base, fields);
+    failure_map_mode = map_mode;
 
-                // Ensure address is within bounds
-                if (addr >= addr_size) continue;
+    return (bin_grade < 0) ? 1 : 0;
+}
 
-                stat_cur_addr = addr;
+/**
+ * @brief Executes a refresh subtest for the RAM chip.
+ *
+ * Writes pseudo-random data to memory, waits for a specified `time_delay`
+ * (simulating refresh interval), then reads back and verifies the data.
+ *
+ * @param addr_size The total number of addresses in the RAM chip.
+ * @param bits The number of data bits in the RAM chip.
+ * @param time_delay The delay in microseconds to simulate refresh interval.
+ * @return 0 if the test passes, 1 if a mismatch is found.
+ */
+static uint32_t refresh_subtest(uint32_t addr_size, uint32_t bits, uint32_t time_delay)
+{
+    uint32_t addr;
+    uint32_t n;
+    uint32_t j;
+    uint32_t failed = 0;
+    bool refresh = ram_refresh_set_enabled(false); // This test needs the delay unrefreshed
 
-                // Determine data to write based on address pattern
-                expected_data = (addr & addr_mask & ram_bit_mask);
+    psrand_seed(random_seeds[0]); // Use the first pre-generated seed
+#if GOLDEN_IMAGE_COMPARE
+    golden_fill_psrand(addr_size, bits);
+    golden_write(addr_size, bits);
+    sleep_us(time_delay); // Wait for the specified delay
+    failed = golden_verify(addr_size, bits);
+#else
+    // Write pseudo-random data to all addresses
+    for (addr = 0; addr < addr_size; addr += n)
+    {
+        n = MIN(RAM_BLOCK_SIZE, addr_size - addr);
+        progress_at(addr);
+        for (j = 0; j < n; j++)
+        {
+            ram_block_out[j] = psrand_next_bits(bits);
+        }
+        ram_write_block(addr, ram_block_out, n);
+    }
 
-                if (expected_data != 0) {
-                    ram_write(addr, ram_bit_mask);
-                } else {
-                    ram_write(addr, ~ram_bit_mask);
-                }
-            }
+    sleep_us(time_delay); // Wait for the specified delay
 
-            // Read and verify phase
-            for (uint32_t i = 0; i < addr_size; i++)
-            {
-                // Calculate same address as write phase
-                switch (pattern) {
-                    case 0: addr = i; break;
-                    case 1: addr = (addr_size - 1) - i; break;
-                    case 2: addr = bit_reverse(i, testable_addr_bits); break;
-                    case 3: addr = 1ULL << (i % testable_addr_bits); break;
-                }
+    psrand_seed(random_seeds[0]); // Reseed with the same seed
+    // Read back and verify data
+    for (addr = 0; addr < addr_size; addr += n)
+    {
+        n = MIN(RAM_BLOCK_SIZE, addr_size - addr);
+        progress_at(addr);
+        ram_read_block(addr, ram_block_in, n);
+        for (j = 0; j < n; j++)
+        {
+            ram_block_out[j] = psrand_next_bits(bits);
+        }
+        failed |= check_block(addr, 1, ram_block_out, ram_block_in, n);
+        if (failed && !failure_map_mode)
+            break; // Stop on first mismatch (failure)
+    }
+#endif
+    ram_refresh_set_enabled(refresh);
+    return failed ? 1 : 0; // 0 if the test passed
+}
+
+/**
+ * @brief Executes the refresh test for the RAM chip.
+ *
+ * Calls `refresh_subtest` with a delay of REFRESH_TEST_DELAY_PCT of the
+ * chip's refresh period. With
+ * `refresh_characterize` set, it then runs the retention-time search and
+ * also fails if any pattern is lost at the shortest delay searched.
+ *
+ * @param addr_size The total number of addresses in the RAM chip.
+ * @param bits The number of data bits in the RAM chip.
+ * @return 0 if the test passes, 1 if a mismatch is found.
+ */
+static uint32_t refresh_test(uint32_t addr_size, uint32_t bits)
+{
+    uint32_t failed;
+
+    failed = refresh_subtest(addr_size, bits, refresh_test_delay_us());
+    if ((failed && !failure_map_mode) || !refresh_characterize)
+        return failed;
+
+    refresh_stress_test(addr_size, bits, &refresh_stress_config, &refresh_stress_results);
+    if (refresh_stress_results.first_failure_delay_ms &&
+        (refresh_stress_results.first_failure_delay_ms <= refresh_stress_config.min_delay_ms))
+        failed = 1;
+    return failed;
+}
+
+/**
+ * @brief Fills the page bursts of a pattern for both checkerboard phases.
+ *
+ * A cell whose physical row and column addresses have odd parity holds
+ * `data ^ checker`, the rest hold `data`. Within a page burst the column
+ * parity alternates, so a burst is one of two blocks depending on the
+ * parity of its row and first column.
+ *
+ * @param data The data word of even cells.
+ * @param checker The bits inverted in odd cells, 0 for a solid pattern.
+ */
+static void fill_pattern_blocks(uint32_t data, uint32_t checker)
+{
+    uint32_t n;
+
+    for (n = 0; n < RAM_BLOCK_SIZE; n++)
+    {
+        pattern_blocks[0][n] = data ^ ((n & 1) ? checker : 0);
+        pattern_blocks[1][n] = data ^ ((n & 1) ? 0 : checker);
+    }
+}
 
-                if (addr >= addr_size) continue;
+/**
+ * @brief Returns the checkerboard phase of a page burst.
+ *
+ * The row is decoded as the chip's encoder splits it: bank bits below the
+ * row select a die or RAS# line and take no part in the parity.
+ *
+ * @param row The row address, as in `addr = col << row_bits | row`.
+ * @param col The first column of the burst.
+ * @return 0 if the burst starts on an even cell, 1 if on an odd one.
+ */
+static inline uint32_t pattern_phase(uint32_t row, uint32_t col)
+{
+    return ((row >> chip_list[main_menu.sel_line]->bank_bits) ^ col) & 1;
+}
 
-                stat_cur_addr = addr;
+/**
+ * @brief Writes a solid or checkerboard pattern to every address, a row at a time.
+ *
+ * @param addr_size The total number of addresses in the RAM chip.
+ * @param data The data word to write to even cells.
+ * @param checker The bits inverted in odd cells, 0 for the same word everywhere.
+ */
+static void write_pattern_rows(uint32_t addr_size, uint32_t data, uint32_t checker)
+{
+    uint32_t row_bits = chip_list[main_menu.sel_line]->row_bits;
+    uint32_t rows = 1 << row_bits;
+    uint32_t cols = addr_size >> row_bits;
+    uint32_t row;
+    uint32_t col;
+    uint32_t n;
+
+    fill_pattern_blocks(data, checker);
+    for (row = 0; row < rows; row++)
+    {
+        for (col = 0; col < cols; col += n)
+        {
+            n = MIN(RAM_BLOCK_SIZE, cols - col);
+            progress_at(row * cols + col); // Progress through the pass
+            ram_write_page(row | (col << row_bits), pattern_blocks[pattern_phase(row, col)], n);
+        }
+    }
+}
 
-                actual_data = ram_read(addr) & ram_bit_mask;
-                expected_data = (addr & addr_mask & ram_bit_mask);
+/**
+ * @brief Reads every address a row at a time and compares it with a solid or checkerboard pattern.
+ *
+ * In CRC mode a full-width compare checks each block by its CRC and only
+ * compares the blocks that mismatch address by address.
+ *
+ * @param addr_size The total number of addresses in the RAM chip.
+ * @param expected The expected data word of even cells (already masked).
+ * @param checker The bits inverted in odd cells (within `mask`), 0 for a solid pattern.
+ * @param mask Data bits to compare.
+ * @param failed_addrs Buffer to store failed addresses (can be NULL).
+ * @param max_failed_addrs Maximum number of failed addresses to record.
+ * @return Number of addresses that did not match.
+ */
+static uint32_t count_pattern_mismatches(uint32_t addr_size, uint32_t expected, uint32_t checker, uint32_t mask,
+                                         uint32_t *failed_addrs, uint32_t max_failed_addrs)
+{
+    uint32_t row_bits = chip_list[main_menu.sel_line]->row_bits;
+    uint32_t rows = 1 << row_bits;
+    uint32_t cols = addr_size >> row_bits;
+    uint32_t row;
+    uint32_t col;
+    uint32_t n;
+    uint32_t j;
+    uint32_t phase;
+    uint32_t want;
+    uint32_t failure_count = 0;
+    bool crc = crc_verify_mode && (mask == 0xffffffff);
+    uint32_t crc_n = 0;
+    uint32_t expect_crc[2] = {0, 0};
 
-                if (actual_data != expected_data)
+    fill_pattern_blocks(expected, checker);
+    for (row = 0; row < rows; row++)
+    {
+        for (col = 0; col < cols; col += n)
+        {
+            n = MIN(RAM_BLOCK_SIZE, cols - col);
+            phase = pattern_phase(row, col);
+            progress_at(row * cols + col);
+            if (crc)
+            {
+                // The expected CRC only depends on the block length and phase
+                if (n != crc_n)
+                {
+                    expect_crc[0] = ram_dma_crc(pattern_blocks[0], n, true);
+                    expect_crc[1] = ram_dma_crc(pattern_blocks[1], n, true);
+                    crc_n = n;
+                }
+                encode_run(ram_dma_cmds, row | (col << row_bits), 1 << row_bits, NULL, n,
+                           chip_list[main_menu.sel_line]->page_mode);
+                ram_refresh_service();
+                row_age_touch(row | (col << row_bits));
+                ram_dma_start_sniffed(ram_dma_cmds, n);
+                ram_dma_wait();
+                if (ram_dma_sniffed_crc() == expect_crc[phase])
+                    continue; // Whole block matched
+            }
+            // Compare address by address, replaying the block if its CRC mismatched
+            ram_read_page(row | (col << row_bits), ram_block_in, n);
+            for (j = 0; j < n; j++)
+            {
+                want = pattern_blocks[phase][j];
+                if ((ram_block_in[j] & mask) != want)
                 {
-                    failed |= (1ULL << bit);
-                    goto next_bit;  // Skip to next bit on failure
+                    pattern_fail_bits |= (ram_block_in[j] & mask) ^ want;
+                    if (failure_map_mode)
+                        failure_map_record(row | ((col + j) << row_bits), (ram_block_in[j] & mask) ^ want);
+                    // Record failed address if buffer provided
+                    if (failed_addrs && failure_count < max_failed_addrs)
+                        failed_addrs[failure_count] = row | ((col + j) << row_bits);
+                    failure_count++;
                 }
             }
+        }
+    }
+    return failure_count;
+}
+
+/**
+ * @brief Executes the Checkerboard test on the RAM chip.
+ *
+ * Writes a physical checkerboard, where every cell holds the opposite of
+ * its neighbours in the same row and column, reads it back, then does the
+ * same with its complement, for as many rounds as the test profile asks
+ * for. Parity comes from the row and column the chip's encoder drives, so
+ * adjacent capacitors are charged opposite ways. On 4-bit parts adjacent
+ * data bits also hold opposite values (0x5 and 0xA).
+ *
+ * @param addr_size The total number of addresses in the RAM chip.
+ * @param bits The number of data bits in the RAM chip.
+ * @return 0 if the test passes, 1 if a mismatch is found.
+ */
+static uint32_t checkerboard_test(uint32_t addr_size, uint32_t bits)
+{
+    uint32_t mask = (1ULL << bits) - 1;
+    uint32_t patterns[2] = {0x55555555 & mask, 0xAAAAAAAA & mask};
+    uint32_t failed = 0;
+    uint32_t p;
+
+    for (int loop = 0; loop < test_profiles[test_profile].checkerboard_loops; loop++)
+    {
+        for (p = 0; p < 2; p++)
+        {
+            // Write the checkerboard, odd cells inverted
+            progress.subtest = 2 * p;
+            write_pattern_rows(addr_size, patterns[p], mask);
+
+            // Read it back and check it
+            progress.subtest = 2 * p + 1;
+            if (count_pattern_mismatches(addr_size, patterns[p], mask, 0xffffffff, NULL, 0))
+            {
+                failed = 1;
+                if (!failure_map_mode)
+                    return 1;
+            }
+        }
+    }
+    return failed;
+}
+
+
+// Bytes with their bits reversed, for reversing an address a byte at a time
+#define REV2(n) n, n + 2 * 64, n + 1 * 64, n + 3 * 64
+#define REV4(n) REV2(n), REV2(n + 2 * 16), REV2(n + 1 * 16), REV2(n + 3 * 16)
+#define REV6(n) REV4(n), REV4(n + 2 * 4), REV4(n + 1 * 4), REV4(n + 3 * 4)
+static const uint8_t bit_reverse_table[256] = {REV6(0), REV6(2), REV6(1), REV6(3)};
+
+/**
+ * @brief Reverses the low bits of a number.
+ *
+ * @param num The number to reverse.
+ * @param num_bits The number of bits to consider, at least 1.
+ * @return The bit-reversed number.
+ */
+static inline uint32_t bit_reverse(uint32_t num, uint32_t num_bits)
+{
+    uint32_t result = ((uint32_t)bit_reverse_table[num & 0xff] << 24) |
+                      ((uint32_t)bit_reverse_table[(num >> 8) & 0xff] << 16) |
+                      ((uint32_t)bit_reverse_table[(num >> 16) & 0xff] << 8) |
+                      bit_reverse_table[num >> 24];
+    return result >> (32 - num_bits);
+}
+
+/**
+ * @brief Returns the address one line away from a base address.
+ *
+ * @param base The base address.
+ * @param line 0 for the base address itself, else 1 + the address line to flip.
+ */
+static inline uint32_t line_neighbour(uint32_t base, uint32_t line)
+{
+    return line ? (base ^ (1u << (line - 1))) : base;
+}
+
+/**
+ * @brief Returns the data word holding the parity of an address in every bit.
+ */
+static inline uint32_t address_parity(uint32_t addr, uint32_t mask)
+{
+    return (__builtin_parity(addr)) ? mask : 0;
+}
+
+/**
+ * @brief Queues one access of the address test, refreshing first if it is due.
+ *
+ * @param addr The address to access.
+ * @param write True to write `data`, false to read.
+ * @param data The data to write.
+ * @param expect The expected read data, or `RAM_STREAM_NO_CHECK`.
+ */
+static inline void address_issue(uint32_t addr, bool write, uint32_t data, uint32_t expect)
+{
+    if (ram_refresh_due())
+    {
+        ram_check_stream_finish(&test_stream); // Empty the pipeline first
+        ram_refresh_catch_up();
+    }
+    ram_check_stream_issue(&test_stream, addr, ram_encode(addr, data, write), expect);
+}
+
+/**
+ * @brief Walks the complement of the data across the address lines around a base address.
+ *
+ * Writes `data` to the base address and to every address one line away
+ * from it, then writes the complement to each of them in turn and checks
+ * that none of the others changed. A line stuck at its level in `base`
+ * makes its address alias the base address, and two shorted lines alias
+ * each other's addresses. Row and column address bits are multiplexed on
+ * the same pins, so each pin is walked once in each half of the address.
+ * Takes (addr_bits + 1) * (addr_bits + 3) accesses.
+ *
+ * @param base 0 for a walking one, all address lines high for a walking zero.
+ * @param addr_bits The number of address lines.
+ * @param data The background data.
+ * @param mask The data bits of the chip.
+ */
+static void walk_address_lines(uint32_t base, uint32_t addr_bits, uint32_t data, uint32_t mask)
+{
+    uint32_t victim;
+    uint32_t v;
+    uint32_t o;
+
+    for (v = 0; v <= addr_bits; v++)
+        address_issue(line_neighbour(base, v), true, data, RAM_STREAM_NO_CHECK);
+
+    for (v = 0; v <= addr_bits; v++)
+    {
+        victim = line_neighbour(base, v);
+        progress_at(victim);
+        address_issue(victim, true, ~data & mask, RAM_STREAM_NO_CHECK);
+        for (o = 0; o <= addr_bits; o++)
+        {
+            if (o != v)
+                address_issue(line_neighbour(base, o), false, 0, data);
+        }
+        address_issue(victim, true, data, RAM_STREAM_NO_CHECK); // Restore the background
+        if (test_stream.failures && !failure_map_mode)
+            break; // Stop early once a failure has been seen
+    }
+}
+
+/**
+ * @brief Writes the parity of every address to it and reads it back.
+ *
+ * Addresses one line apart have opposite parity, so a cell selected by
+ * the address one line away from its own reads back wrong. The writes go
+ * in Gray-code order, each changing one address line, and the reads in
+ * bit-reversed order, toggling the top lines on every access. The
+ * complementary sweep writes the inverted parity in the opposite order,
+ * so of two aliased cells it writes the other one last.
+ *
+ * @param addr_size The total number of addresses in the RAM chip.
+ * @param addr_bits The number of address lines.
+ * @param mask The data bits of the chip.
+ * @param complement True for the complementary sweep.
+ */
+static void address_parity_sweep(uint32_t addr_size, uint32_t addr_bits, uint32_t mask, bool complement)
+{
+    uint32_t flip = complement ? mask : 0;
+    uint32_t addr;
+    uint32_t i;
+    uint32_t n;
+
+    for (n = 0; n < addr_size; n++)
+    {
+        i = complement ? (addr_size - 1 - n) : n;
+        addr = i ^ (i >> 1);
+        if ((n & (PROGRESS_INTERVAL - 1)) == 0)
+            progress_at(addr);
+        address_issue(addr, true, address_parity(addr, mask) ^ flip, RAM_STREAM_NO_CHECK);
+    }
+
+    for (n = 0; n < addr_size; n++)
+    {
+        i = complement ? (addr_size - 1 - n) : n;
+        addr = bit_reverse(i, addr_bits);
+        if ((n & (PROGRESS_INTERVAL - 1)) == 0)
+            progress_at(addr);
+        address_issue(addr, false, 0, address_parity(addr, mask) ^ flip);
+        if (test_stream.failures && !failure_map_mode)
+            break; // Stop early once a failure has been seen
+    }
+}
+
+/**
+ * @brief Returns the number of address lines of a chip, counting both halves of the address.
+ *
+ * @param addr_size The total number of addresses in the RAM chip, a power of two.
+ */
+static uint32_t address_lines(uint32_t addr_size)
+{
+    uint32_t addr_bits = 0;
+
+    while ((1u << addr_bits) < addr_size)
+        addr_bits++;
+    return addr_bits;
+}
+
+/**
+ * @brief Address decoder test.
+ *
+ * Walks a one and a zero across every row and column address line, with
+ * the data background and its complement, then sweeps the address parity
+ * through the whole chip as many times as the test profile asks. The walks
+ * find stuck and shorted address lines in O(log^2 n) accesses; each sweep
+ * adds 2n and finds single addresses that select the wrong cell.
+ *
+ * @param addr_size The total number of addresses in the RAM chip.
+ * @param bits The number of data bits in the RAM chip.
+ * @return 0 if all tests pass, bitmask indicating which bits failed.
+ */
+static uint32_t address_in_address_test(uint32_t addr_size, uint32_t bits)
+{
+    uint32_t mask = (1ULL << bits) - 1;
+    uint32_t addr_bits = address_lines(addr_size);
+    uint32_t failed = 0;
+    uint8_t round;
+
+    ram_bit_mask = mask;
+    progress.bit = 0;
+
+    // Walking one then walking zero, over a background of zeros then of ones
+    for (round = 0; round < 4; round++)
+    {
+        progress.subtest = round & 1;
+        ram_check_stream_init(&test_stream, mask, map_fail_fn());
+        walk_address_lines((round & 1) ? (addr_size - 1) : 0, addr_bits, (round & 2) ? mask : 0, mask);
+        if (!ram_check_stream_finish(&test_stream))
+        {
+            failed |= test_stream.fail_bits;
+            if (!failure_map_mode)
+                return failed;
+        }
+    }
 
-            next_bit:;  // Label for goto
+    for (round = 0; round < test_profiles[test_profile].address_sweeps; round++)
+    {
+        progress.subtest = 2 + (round & 1);
+        ram_check_stream_init(&test_stream, mask, map_fail_fn());
+        address_parity_sweep(addr_size, addr_bits, mask, round & 1);
+        if (!ram_check_stream_finish(&test_stream))
+        {
+            failed |= test_stream.fail_bits;
+            if (!failure_map_mode)
+                return failed;
         }
     }
 
@@ -673,13 +2062,8 @@ static uint32_t address_in_address_test(uint32_t addr_size, uint32_t bits)
  */
 static void fill_memory_pattern(uint32_t addr_size, uint32_t pattern, uint32_t bit_mask)
 {
-    for (uint32_t addr = 0; addr < addr_size; addr++) {
-        stat_cur_addr = addr;
-
-        // Apply bit mask to pattern
-        uint32_t masked_pattern = (pattern & bit_mask) ? bit_mask : ~bit_mask;
-        ram_write(addr, masked_pattern);
-    }
+    // Only the masked bits are checked, so the pattern can cover several DQ lines at once
+    write_pattern_rows(addr_size, pattern & bit_mask, 0);
 }
 
 /**
@@ -696,25 +2080,10 @@ static uint32_t verify_memory_pattern(uint32_t addr_size, uint32_t expected_patt
                                      uint32_t bit_mask, uint32_t *failed_addrs, 
                                      uint32_t max_failed_addrs)
 {
-    uint32_t failure_count = 0;
-    uint32_t expected_data = (expected_pattern & bit_mask) ? bit_mask : ~bit_mask;
-
-    for (uint32_t addr = 0; addr < addr_size; addr++) {
-        stat_cur_addr = addr;
-
-        uint32_t actual_data = ram_read(addr) & bit_mask;
-
-        if (actual_data != expected_data) {
-            failure_count++;
-
-            // Record failed address if buffer provided
-            if (failed_addrs && (failure_count - 1) < max_failed_addrs) {
-                failed_addrs[failure_count - 1] = addr;
-            }
-        }
-    }
+    uint32_t expected_data = expected_pattern & bit_mask;
 
-    return failure_count;
+    return count_pattern_mismatches(addr_size, expected_data, 0, bit_mask,
+                                    failed_addrs, max_failed_addrs);
 }
 
 /**
@@ -731,18 +2100,140 @@ static uint32_t refresh_stress_subtest(uint32_t addr_size, uint32_t bits,
                                       uint32_t pattern, uint32_t delay_ms, 
                                       uint32_t bit_mask)
 {
+    bool refresh = ram_refresh_set_enabled(false);
+    uint32_t failures;
+
     // Phase 1: Fill memory with test pattern
-    stat_cur_subtest = 0;  // Write phase
+    progress.subtest = 0;  // Write phase
     fill_memory_pattern(addr_size, pattern, bit_mask);
 
     // Phase 2: Wait without refresh (this is the critical part)
-    stat_cur_subtest = 1;  // Stress phase
+    progress.subtest = 1;  // Stress phase
 
-    // Note: In a real implementation, you would need hardware control
-    // to actually disable DRAM refresh. This is a simulation of the delay.
+    // The background refresh is off and the state machine only refreshes the
+    // rows it accesses, so nothing is refreshed while core1 sleeps here
     sleep_ms(delay_ms);
 
     // Phase 3: Verify data integrity
-    stat_cur_subtest = 2;  // Verify phase
-    return verify_memory_pattern(addr_size, pattern, bit_mask, NULL, 0);
+    progress.subtest = 2;  // Verify phase
+    failures = verify_memory_pattern(addr_size, pattern, bit_mask, NULL, 0);
+    ram_refresh_set_enabled(refresh);
+    return failures;
+}
+
+/**
+ * @brief Binary-searches the longest delay one pattern survives.
+ *
+ * Retention falls as the delay grows, so each pass halves the interval
+ * between the longest delay known to pass and the shortest known to fail.
+ * A linear sweep of `delay_steps` delays needs that many passes; this needs
+ * about log2(delay_steps) of them.
+ *
+ * @param addr_size Number of addresses to test.
+ * @param bits Number of data bits.
+ * @param pattern Test pattern to use.
+ * @param config Delay range and resolution of the search.
+ * @param fail_delay_ms Receives the shortest failing delay, or 0 if none failed.
+ * @param failures Receives the number of failed addresses at that delay.
+ * @return The longest delay that passed, or 0 if the shortest delay failed.
+ */
+static uint32_t refresh_stress_search(uint32_t addr_size, uint32_t bits, uint32_t pattern,
+                                      const refresh_stress_config_t *config,
+                                      uint32_t *fail_delay_ms, uint32_t *failures)
+{
+    uint32_t bit_mask = (1ULL << bits) - 1;
+    uint32_t step = MAX((config->max_delay_ms - config->min_delay_ms) / MAX(config->delay_steps, 1), 1);
+    uint32_t lo = config->min_delay_ms;
+    uint32_t hi = config->max_delay_ms;
+    uint32_t mid;
+    uint32_t n;
+
+    *fail_delay_ms = 0;
+    *failures = 0;
+
+    // Bracket the search. Most chips pass the whole range at room temperature.
+    n = refresh_stress_subtest(addr_size, bits, pattern, hi, bit_mask);
+    if (n == 0)
+        return hi;
+    *fail_delay_ms = hi;
+    *failures = n;
+    n = refresh_stress_subtest(addr_size, bits, pattern, lo, bit_mask);
+    if (n)
+    {
+        *fail_delay_ms = lo;
+        *failures = n;
+        return 0;
+    }
+
+    // lo always passes and hi always fails
+    while (hi - lo > step)
+    {
+        mid = lo + (hi - lo) / 2;
+        n = refresh_stress_subtest(addr_size, bits, pattern, mid, bit_mask);
+        if (n)
+        {
+            hi = mid;
+            *fail_delay_ms = mid;
+            *failures = n;
+        }
+        else
+        {
+            lo = mid;
+        }
+    }
+    return lo;
+}
+
+/**
+ * @brief Characterizes the retention time of the RAM chip.
+ *
+ * Searches the longest delay without refresh that each of the refresh test
+ * patterns survives. The results hold the worst case over all patterns.
+ *
+ * @param addr_size Number of addresses to test.
+ * @param bits Number of data bits.
+ * @param config Delay range, resolution and number of patterns.
+ * @param results Receives the retention results.
+ */
+void refresh_stress_test(uint32_t addr_size, uint32_t bits, const refresh_stress_config_t *config,
+                         refresh_stress_results_t *results)
+{
+    uint32_t patterns = MIN(MAX(config->pattern_iterations, 1), NUM_REFRESH_PATTERNS);
+    uint32_t fail_delay;
+    uint32_t working;
+    uint32_t p;
+    bool map_mode;
+
+    results->max_working_delay_ms = config->max_delay_ms;
+    results->first_failure_delay_ms = 0;
+    results->failed_addresses = 0;
+    results->weak_bit_mask = 0;
+
+    for (p = 0; p < NUM_REFRESH_PATTERNS; p++)
+    {
+        results->pattern_failures[p] = 0;
+    }
+
+    // Failures past the retention limit are expected, so keep them out of the map
+    map_mode = failure_map_mode;
+    failure_map_mode = false;
+
+    for (p = 0; p < patterns; p++)
+    {
+        progress.bit = p & 3; // Update current pattern for UI visualization
+        pattern_fail_bits = 0;
+        working = refresh_stress_search(addr_size, bits, refresh_test_patterns[p], config,
+                                        &fail_delay, &results->pattern_failures[p]);
+        results->max_working_delay_ms = MIN(results->max_working_delay_ms, working);
+        if (fail_delay)
+        {
+            results->weak_bit_mask |= pattern_fail_bits;
+            if ((results->first_failure_delay_ms == 0) || (fail_delay < results->first_failure_delay_ms))
+            {
+                results->first_failure_delay_ms = fail_delay;
+                results->failed_addresses = results->pattern_failures[p];
+            }
+        }
+    }
+    failure_map_mode = map_mode;
 }
@@ -7,9 +7,87 @@
 // Function prototypes
 int ram_read(int addr);
 void ram_write(int addr, int data);
+uint32_t ram_encode(int addr, int data, bool write);
+void ram_read_block(int addr, uint32_t *data, uint32_t count);
+void ram_write_block(int addr, const uint32_t *data, uint32_t count);
+void ram_read_page(int addr, uint32_t *data, uint32_t count);
+void ram_write_page(int addr, const uint32_t *data, uint32_t count);
 uint32_t all_ram_tests(uint32_t addr_size, uint32_t bits);
+uint32_t shmoo_test(uint32_t addr_size, uint32_t bits);
+uint32_t bin_test(uint32_t addr_size, uint32_t bits);
 void psrand_init_seeds();
 
+// March test operations
+typedef enum {
+    MARCH_R0,
+    MARCH_R1,
+    MARCH_W0,
+    MARCH_W1
+} march_op_t;
+
+// Address order of a March element
+typedef enum {
+    MARCH_UP,
+    MARCH_DOWN
+} march_order_t;
+
+#define MARCH_MAX_OPS 6
+#define MARCH_MAX_ELEMENTS 6
+
+/**
+ * @brief One March element: an address order and the ops applied at each address.
+ */
+typedef struct {
+    uint8_t order;                // march_order_t
+    uint8_t num_ops;
+    uint8_t ops[MARCH_MAX_OPS];   // march_op_t
+} march_element_t;
+
+/**
+ * @brief A March algorithm as a sequence of elements.
+ */
+typedef struct {
+    const char *name;
+    uint8_t num_elements;
+    march_element_t elements[MARCH_MAX_ELEMENTS];
+} march_algorithm_t;
+
+// March algorithms available to the March test
+typedef enum {
+    MARCH_B,
+    MARCH_C_MINUS,
+    MARCH_SS,
+    MARCH_LR,
+    MATS_PLUS_PLUS,
+    NUM_MARCH_ALGORITHMS
+} march_algorithm_id_t;
+
+const char *march_algorithm_name(march_algorithm_id_t id);
+
+/**
+ * @brief How much of each test `all_ram_tests` runs.
+ */
+typedef struct {
+    const char *name;
+    uint8_t tests;              // Tests run, bit i for entry i of ram_test_names
+    uint8_t pseudo_seeds;       // Seeds of the pseudo-random test, at most PSEUDO_VALUES
+    uint8_t checkerboard_loops; // Rounds of both checkerboard patterns
+    uint8_t address_sweeps;     // Address parity sweeps after the address line walks, alternately complemented
+} test_profile_t;
+
+// Test depth profiles, from an incoming-inspection screen to a full soak
+typedef enum {
+    TEST_PROFILE_QUICK,
+    TEST_PROFILE_STANDARD,
+    TEST_PROFILE_THOROUGH,
+    NUM_TEST_PROFILES
+} test_profile_id_t;
+
+const char *test_profile_name(test_profile_id_t id);
+uint64_t test_profile_accesses(test_profile_id_t id, uint32_t addr_size, uint32_t bits);
+uint64_t test_profile_page_accesses(test_profile_id_t id, uint32_t addr_size);
+uint32_t test_profile_wait_us(test_profile_id_t id);
+
 // Function queue entry for dispatching worker functions
 typedef struct
 {
@@ -43,4 +121,7 @@ typedef struct {
     uint32_t pattern_failures[8];   // Failures per test pattern
 } refresh_stress_results_t;
 
+void refresh_stress_test(uint32_t addr_size, uint32_t bits, const refresh_stress_config_t *config,
+                         refresh_stress_results_t *results);
+
 #endif //DRAM_TESTS_H
@@ -0,0 +1,148 @@
+/*
+ * failure_map.c
+ *
+ * Full-chip failure bitmap. In "map all failures" mode the tests record
+ * every failing read here instead of stopping at the first one, so the
+ * summary can tell a single weak cell from a dead row or column.
+ */
+
+#include <string.h>
+#include "pico/stdlib.h"
+#include "failure_map.h"
+
+// One bit per address, over the whole run and over the current test only
+static uint32_t failure_map[FAILURE_MAP_CELLS / 32];
+static uint32_t failure_test_map[FAILURE_MAP_CELLS / 32];
+
+// Running counts kept as failures are recorded: addresses per test, reads per DQ line
+static uint32_t failure_test;
+static uint32_t failure_per_test[FAILURE_MAP_TESTS];
+static uint32_t failure_per_bit[4];
+
+// Per-line counts, built by failure_map_summarize
+static uint16_t failure_rows[FAILURE_MAP_LINES];
+static uint16_t failure_cols[FAILURE_MAP_LINES];
+
+/**
+ * @brief Clears the map and all counts before a new run.
+ */
+void failure_map_clear()
+{
+    memset(failure_map, 0, sizeof(failure_map));
+    memset(failure_test_map, 0, sizeof(failure_test_map));
+    memset(failure_per_test, 0, sizeof(failure_per_test));
+    memset(failure_per_bit, 0, sizeof(failure_per_bit));
+    failure_test = 0;
+}
+
+/**
+ * @brief Sets the test that following failures are charged to.
+ *
+ * Each test counts the addresses it finds failing once, however many
+ * times it reads them wrong.
+ *
+ * @param test Index of the test in all_ram_tests.
+ */
+void failure_map_set_test(uint32_t test)
+{
+    failure_test = MIN(test, FAILURE_MAP_TESTS - 1);
+    memset(failure_test_map, 0, sizeof(failure_test_map));
+}
+
+/**
+ * @brief Records a failing read.
+ *
+ * @param addr The address that read back wrong.
+ * @param bad_bits The data bits that differed from the expected value.
+ */
+void failure_map_record(uint32_t addr, uint32_t bad_bits)
+{
+    uint32_t bit;
+
+    if (addr >= FAILURE_MAP_CELLS)
+        return;
+    failure_map[addr / 32] |= 1u << (addr % 32);
+    if (!(failure_test_map[addr / 32] & (1u << (addr % 32))))
+    {
+        failure_test_map[addr / 32] |= 1u << (addr % 32);
+        failure_per_test[failure_test]++;
+    }
+    for (bit = 0; bit < 4; bit++)
+    {
+        if (bad_bits & (1u << bit))
+            failure_per_bit[bit]++;
+    }
+}
+
+/**
+ * @brief Checks whether an address has failed.
+ *
+ * @param addr The address.
+ * @return True if any failure has been recorded at the address.
+ */
+bool failure_map_cell(uint32_t addr)
+{
+    return (addr < FAILURE_MAP_CELLS) && (failure_map[addr / 32] & (1u << (addr % 32)));
+}
+
+/**
+ * @brief Builds the failing address, row and column counts from the map.
+ *
+ * The per-test address counts and per-DQ read counts are kept as the
+ * failures are recorded and copied in.
+ *
+ * @param addr_size The total number of addresses in the RAM chip.
+ * @param row_bits Low address bits that form the row address.
+ * @param summary Receives the summary.
+ */
+void failure_map_summarize(uint32_t addr_size, uint32_t row_bits, failure_summary_t *summary)
+{
+    uint32_t rows = 1 << row_bits;
+    uint32_t cols = addr_size >> row_bits;
+    uint32_t addr;
+    uint32_t w;
+    uint32_t i;
+
+    memset(summary, 0, sizeof(*summary));
+    memset(failure_rows, 0, sizeof(failure_rows));
+    memset(failure_cols, 0, sizeof(failure_cols));
+    memcpy(summary->per_test, failure_per_test, sizeof(failure_per_test));
+    memcpy(summary->per_bit_reads, failure_per_bit, sizeof(failure_per_bit));
+
+    for (w = 0; w < MIN(addr_size, FAILURE_MAP_CELLS) / 32; w++)
+    {
+        if (failure_map[w] == 0)
+            continue; // Skip clean words quickly
+        for (i = 0; i < 32; i++)
+        {
+            if (failure_map[w] & (1u << i))
+            {
+                addr = w * 32 + i;
+                summary->cells++;
+                failure_rows[addr & (rows - 1)]++;
+                failure_cols[addr >> row_bits]++;
+            }
+        }
+    }
+
+    for (i = 0; i < MIN(rows, FAILURE_MAP_LINES); i++)
+    {
+        if (failure_rows[i])
+            summary->bad_rows++;
+        if (failure_rows[i] > summary->worst_row_cells)
+        {
+            summary->worst_row = i;
+            summary->worst_row_cells = failure_rows[i];
+        }
+    }
+    for (i = 0; i < MIN(cols, FAILURE_MAP_LINES); i++)
+    {
+        if (failure_cols[i])
+            summary->bad_cols++;
+        if (failure_cols[i] > summary->worst_col_cells)
+        {
+            summary->worst_col = i;
+            summary->worst_col_cells = failure_cols[i];
+        }
+    }
+}
@@ -0,0 +1,36 @@
+#ifndef FAILURE_MAP_H
+#define FAILURE_MAP_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Largest supported chip has 256K addresses, so the map is 32KB
+#define FAILURE_MAP_CELLS 262144
+// Number of tests in all_ram_tests
+#define FAILURE_MAP_TESTS 5
+// Largest row or column count of any supported chip
+#define FAILURE_MAP_LINES 512
+
+/**
+ * @brief Summary of a full-chip failure map.
+ */
+typedef struct {
+    uint32_t cells;                        // Distinct failing addresses
+    uint32_t per_test[FAILURE_MAP_TESTS];  // Distinct failing addresses found by each test
+    uint32_t per_bit_reads[4];             // Failing reads on each DQ line, every read counted
+    uint32_t bad_rows;                     // Rows with at least one failing cell
+    uint32_t bad_cols;                     // Columns with at least one failing cell
+    uint32_t worst_row;                    // Row with the most failing cells
+    uint32_t worst_row_cells;
+    uint32_t worst_col;                    // Column with the most failing cells
+    uint32_t worst_col_cells;
+} failure_summary_t;
+
+// Function prototypes
+void failure_map_clear();
+void failure_map_set_test(uint32_t test);
+void failure_map_record(uint32_t addr, uint32_t bad_bits);
+bool failure_map_cell(uint32_t addr);
+void failure_map_summarize(uint32_t addr_size, uint32_t row_bits, failure_summary_t *summary);
+
+#endif //FAILURE_MAP_H
@@ -0,0 +1,186 @@
+/*
+ * bench_main.c
+ *
+ * Benchmarks the test engine on the host. Each chip in chip_list is
+ * replaced by an in-memory chip of the same geometry and all_ram_tests
+ * runs against it, unchanged. The benchmark follows stat_cur_test, as the
+ * UI does, to split the accesses and time between the tests.
+ *
+ * Usage: dram_bench [-c chip] [-p profile]
+ *
+ * Times are wall-clock and include the sleeps the tests make. Setup is
+ * everything before the first test: the transport measurement and the
+ * initial March element. The profile is an index into the test profiles,
+ * Thorough by default, and the accesses it is predicted to make are shown
+ * next to the total. Exits with status 1 if any test fails, which on
+ * a perfect memory means the engine is broken.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "app_state.h"
+#include "ram_refresh.h"
+#include "mem_pio.h"
+
+// Index of the setup phase in the results, after the tests
+#define BENCH_SETUP NUM_RAM_TESTS
+
+/**
+ * @brief Accesses and time spent in one test.
+ */
+typedef struct {
+    uint64_t accesses;
+    uint64_t ns;
+} bench_result_t;
+
+static bench_result_t bench_results[NUM_RAM_TESTS + 1];
+static int bench_phase;
+static uint64_t bench_phase_start_ns;
+static uint64_t bench_phase_start_accesses;
+
+/**
+ * @brief Returns the host's monotonic clock in nanoseconds.
+ */
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+/**
+ * @brief Charges the accesses and time since the last switch to the current phase.
+ */
+static void close_phase(void)
+{
+    uint64_t ns = now_ns();
+    uint64_t accesses = mem_pio_accesses();
+
+    bench_results[bench_phase].ns += ns - bench_phase_start_ns;
+    bench_results[bench_phase].accesses += accesses - bench_phase_start_accesses;
+    bench_phase_start_ns = ns;
+    bench_phase_start_accesses = accesses;
+}
+
+/**
+ * @brief Switches phase when the engine announces a new test. Called after every access.
+ */
+static void observe(void)
+{
+    int test;
+
+    if (queue_is_empty(&stat_cur_test))
+        return;
+    close_phase();
+    while (queue_try_remove(&stat_cur_test, &test)) {}
+    bench_phase = test;
+}
+
+/**
+ * @brief Prints one row of results.
+ */
+static void print_result(const char *name, const bench_result_t *r)
+{
+    double seconds = r->ns / 1e9;
+
+    printf("  %-16s %12llu %10.1f %12.2f\n", name, (unsigned long long)r->accesses, r->ns / 1e6,
+           seconds > 0 ? r->accesses / seconds / 1e6 : 0.0);
+}
+
+/**
+ * @brief Runs every test on one chip geometry and prints the time each took.
+ *
+ * @param index The chip's index in chip_list.
+ * @return True if every test passed.
+ */
+static bool bench_chip(uint8_t index)
+{
+    const mem_chip_t *chip;
+    bench_result_t total = {0, 0};
+    uint64_t all_accesses;
+    uint32_t failed;
+    int test;
+
+    if (!mem_pio_install(index))
+        panic("Out of memory for the cells");
+    chip = chip_list[index];
+    main_menu.sel_line = index;
+    chip->setup_pio(0, 0);
+
+    memset(bench_results, 0, sizeof(bench_results));
+    while (queue_try_remove(&stat_cur_test, &test)) {}
+    bench_phase = BENCH_SETUP;
+    bench_phase_start_ns = now_ns();
+    bench_phase_start_accesses = 0;
+    mem_pio_set_observer(observe);
+
+    failed = all_ram_tests(chip->mem_size, chip->bits);
+    ram_refresh_stop();
+    close_phase();
+    mem_pio_set_observer(NULL);
+    chip->teardown_pio();
+
+    printf("%s: %u addresses x %u bits, %u row bits%s, %s transport%s\n", chip->chip_name, chip->mem_size,
+           chip->bits, chip->row_bits, chip->page_mode ? ", page mode" : "",
+           (ram_transport == RAM_TRANSPORT_DMA) ? "DMA" : "polled", failed ? ", FAILED" : "");
+    printf("  %-16s %12s %10s %12s\n", "test", "accesses", "ms", "Maccess/s");
+    print_result("(setup)", &bench_results[BENCH_SETUP]);
+    for (test = 0; test < NUM_RAM_TESTS; test++) {
+        print_result(ram_test_names[test], &bench_results[test]);
+        total.accesses += bench_results[test].accesses;
+        total.ns += bench_results[test].ns;
+    }
+    print_result("(tests)", &total);
+    all_accesses = total.accesses + bench_results[BENCH_SETUP].accesses;
+    printf("  %s profile: %llu accesses, %llu predicted\n", test_profile_name(test_profile),
+           (unsigned long long)all_accesses,
+           (unsigned long long)test_profile_accesses(test_profile, chip->mem_size, chip->bits));
+
+    mem_pio_remove();
+    return failed == 0;
+}
+
+int main(int argc, char **argv)
+{
+    int chip = -1;
+    int profile = TEST_PROFILE_THOROUGH;
+    bool ok = true;
+    uint8_t i;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "c:p:")) != -1) {
+        switch (opt) {
+        case 'c':
+            chip = atoi(optarg);
+            break;
+        case 'p':
+            profile = atoi(optarg);
+            break;
+        default:
+            fprintf(stderr, "Usage: %s [-c chip] [-p profile]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (chip >= NUM_CHIPS) {
+        fprintf(stderr, "There are %u chips\n", NUM_CHIPS);
+        return 2;
+    }
+    if ((profile < 0) || (profile >= NUM_TEST_PROFILES)) {
+        fprintf(stderr, "There are %u test profiles\n", NUM_TEST_PROFILES);
+        return 2;
+    }
+    test_profile = profile;
+
+    psrand_init_seeds();
+    queue_init(&stat_cur_test, sizeof(int), 2);
+    for (i = 0; i < NUM_CHIPS; i++) {
+        if ((chip >= 0) && (i != chip))
+            continue;
+        ok &= bench_chip(i);
+    }
+    return ok ? 0 : 1;
+}
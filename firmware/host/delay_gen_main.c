@@ -0,0 +1,107 @@
+/*
+ * delay_gen_main.c
+ *
+ * Generates the PIO delay tables of every chip when the firmware is built.
+ * The datasheet timing of each speed grade and the timing rules of its PIO
+ * program are read straight from the .pio files, built with RAM_DELAY_GEN
+ * so that only those parts are compiled, and ram_timing_generate turns
+ * them into delays at the base clock. The tables are written as a header
+ * of initializers that the .pio files include.
+ *
+ * Usage: delay_gen out.h
+ *
+ * Exits with status 1, writing nothing, if any speed grade cannot be met
+ * within the 5-bit delay fields, so a bad timing entry fails the build.
+ */
+
+#include <stdio.h>
+#include "pio_timing.h"
+
+#define RAM_DELAY_GEN
+#include "ram4116.pio.h"
+#include "ram4132.pio.h"
+#include "ram4164.pio.h"
+#include "ram41128.pio.h"
+#include "ram41256.pio.h"
+#include "ram_4bit.pio.h"
+
+/**
+ * @brief One delay table to generate, and what it is generated from.
+ */
+typedef struct {
+    const char *name;                // Prefix of the initializer macro
+    const ram_timing_t *timings;     // Datasheet timing of each grade
+    uint8_t grades;
+    const ram_timing_rules_t *rules; // Rules of the program the table patches
+} delay_table_t;
+
+static const delay_table_t delay_tables[] = {
+    {"RAM4027",  ram4027_timings,  RAM4027_DELAYS,  &ram4116_rules},
+    {"RAM4116",  ram4116_timings,  RAM4116_DELAYS,  &ram4116_rules},
+    {"RAM4132",  ram4132_timings,  RAM4132_DELAYS,  &ram4132_rules},
+    {"RAM4164",  ram4164_timings,  RAM4164_DELAYS,  &ram4164_rules},
+    {"RAM41128", ram41128_timings, RAM41128_DELAYS, &ram41128_rules},
+    {"RAM41256", ram41256_timings, RAM41256_DELAYS, &ram41256_rules},
+    {"RAM44256", ram44256_timings, RAM44256_DELAYS, &ram_4bit_rules},
+    {"RAM4464",  ram4464_timings,  RAM4464_DELAYS,  &ram_4bit_rules},
+    {"RAM4416",  ram4416_timings,  RAM4416_DELAYS,  &ram_4bit_rules},
+};
+
+#define NUM_DELAY_TABLES (sizeof(delay_tables) / sizeof(delay_tables[0]))
+
+// Most grades of any table
+#define MAX_GRADES 8
+
+static uint8_t delays[NUM_DELAY_TABLES][MAX_GRADES][32];
+
+int main(int argc, char **argv)
+{
+    const delay_table_t *t;
+    FILE *out;
+    uint32_t i;
+    uint8_t grade;
+    uint8_t f;
+
+    if (argc != 2) {
+        fprintf(stderr, "usage: delay_gen out.h\n");
+        return 1;
+    }
+
+    // Generate every table before writing any, so a failure leaves no header behind
+    for (i = 0; i < NUM_DELAY_TABLES; i++) {
+        t = &delay_tables[i];
+        if (t->grades > MAX_GRADES) {
+            fprintf(stderr, "delay_gen: %s has more than %d grades\n", t->name, MAX_GRADES);
+            return 1;
+        }
+        for (grade = 0; grade < t->grades; grade++) {
+            if (!ram_timing_generate(&t->timings[grade], t->rules, PIO_TIMING_BASE_KHZ, delays[i][grade])) {
+                fprintf(stderr, "delay_gen: %s grade %u (tRAC %u ns) cannot be met at %u kHz\n",
+                        t->name, grade, t->timings[grade].trac, PIO_TIMING_BASE_KHZ);
+                return 1;
+            }
+        }
+    }
+
+    out = fopen(argv[1], "w");
+    if (!out) {
+        perror(argv[1]);
+        return 1;
+    }
+    fprintf(out, "// Generated by host/delay_gen from the timings in the .pio files. Do not edit.\n");
+    fprintf(out, "#ifndef RAM_DELAYS_H\n#define RAM_DELAYS_H\n");
+    for (i = 0; i < NUM_DELAY_TABLES; i++) {
+        t = &delay_tables[i];
+        fprintf(out, "\n#define %s_DELAY_TABLE { \\\n", t->name);
+        for (grade = 0; grade < t->grades; grade++) {
+            fprintf(out, "    {");
+            for (f = 0; f < t->rules->delay_fields; f++)
+                fprintf(out, "%s%2u", f ? ", " : "", delays[i][grade][f]);
+            fprintf(out, "}%s /* tRAC %u ns */ \\\n", (grade + 1 < t->grades) ? "," : " ",
+                    t->timings[grade].trac);
+        }
+        fprintf(out, "}\n");
+    }
+    fprintf(out, "\n#endif // RAM_DELAYS_H\n");
+    return fclose(out) ? 1 : 0;
+}
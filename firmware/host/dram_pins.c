@@ -0,0 +1,235 @@
+/*
+ * dram_pins.c
+ *
+ * A DRAM chip modelled at its pins, for the PIO simulator. Every cycle it
+ * looks for edges on RAS#, CAS# and WE#, latches addresses, stores and
+ * returns data, and records the interval behind each edge against the
+ * timing parameter it is limited by. Reads drive deliberately wrong data
+ * until the datasheet access times have passed, so a program that samples
+ * too early reads back garbage as it would on a marginal chip.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "dram_pins.h"
+#include "pio_sim.h"
+
+/**
+ * @brief Returns the level of one pin, or 1 (inactive) for a pin the chip does not have.
+ */
+static uint32_t pin_level(uint32_t levels, int8_t gpio)
+{
+    return (gpio < 0) ? 1 : (levels >> gpio) & 1;
+}
+
+/**
+ * @brief Keeps the shortest interval seen for a parameter in the current phase.
+ */
+static void record(dram_pins_t *d, ram_timing_param_t param, uint64_t ps)
+{
+    dram_pins_stats_t *s;
+
+    if (d->phase >= DRAM_PHASES)
+        return;
+    s = &d->stats[d->phase];
+    if (ps < s->min_ps[param])
+        s->min_ps[param] = (uint32_t)ps;
+}
+
+/**
+ * @brief Returns where a cell of a bank lives in the cell array.
+ */
+static uint32_t cell_index(dram_pins_t *d, uint8_t b)
+{
+    return ((uint32_t)b << (2 * d->map.addr_bits)) | (d->bank[b].col << d->map.addr_bits) | d->bank[b].row;
+}
+
+/**
+ * @brief Stores D into the cell open in a bank.
+ */
+static void write_cell(dram_pins_t *d, uint8_t b, uint32_t levels)
+{
+    d->cells[cell_index(d, b)] = (levels >> d->map.din_base) & ((1u << d->map.data_bits) - 1);
+    d->bank[b].written = true;
+    d->bank[b].reading = false;
+    d->we_wrote = true;
+}
+
+/**
+ * @brief Sets up a chip with every cell cleared.
+ *
+ * @param d The chip.
+ * @param map The GPIO of each of its pins.
+ * @param spec The datasheet timing its read data follows.
+ * @return False if the cells could not be allocated.
+ */
+bool dram_pins_init(dram_pins_t *d, const dram_pins_map_t *map, const ram_timing_t *spec)
+{
+    memset(d, 0, sizeof(*d));
+    d->map = *map;
+    d->spec = spec;
+    d->phase = DRAM_PHASES; // Record nothing until a phase is chosen
+    d->last_bank = -1;
+    memset(d->stats, 0xff, sizeof(d->stats));
+    d->cells = calloc((size_t)DRAM_PINS_BANKS << (2 * map->addr_bits), 1);
+    return d->cells != NULL;
+}
+
+/**
+ * @brief Releases the cells of a chip.
+ */
+void dram_pins_free(dram_pins_t *d)
+{
+    free(d->cells);
+    d->cells = NULL;
+}
+
+/**
+ * @brief Starts recording the timing of another kind of access.
+ *
+ * Forgets the previous RAS# edges so no interval spans the idle time
+ * between phases.
+ *
+ * @param d The chip.
+ * @param phase The kind of access that follows.
+ */
+void dram_pins_set_phase(dram_pins_t *d, dram_phase_t phase)
+{
+    uint8_t b;
+
+    d->phase = phase;
+    for (b = 0; b < DRAM_PINS_BANKS; b++) {
+        d->bank[b].ras_seen = false;
+        d->bank[b].ras_rise_seen = false;
+    }
+}
+
+/**
+ * @brief Steps the chip by one cycle. Matches pio_sim_device_t.cycle.
+ */
+void dram_pins_cycle(void *ctx, uint64_t cycle, uint32_t out, uint32_t oe, uint32_t *drive, uint32_t *drive_mask)
+{
+    dram_pins_t *d = ctx;
+    dram_pins_bank_t *bank;
+    uint64_t now = pio_sim_time_ps(cycle);
+    uint32_t levels = out & oe;
+    uint32_t data_mask = ((1u << d->map.data_bits) - 1) << d->map.dout_base;
+    uint32_t addr = (levels >> d->map.addr_base) & ((1u << d->map.addr_bits) - 1);
+    bool we_low = !pin_level(levels, d->map.we);
+    bool ras_low, cas_low;
+    uint8_t b;
+
+    if (we_low && !d->we_low) {
+        d->we_fall = now;
+        d->we_wrote = false;
+    }
+
+    for (b = 0; b < DRAM_PINS_BANKS; b++) {
+        if (d->map.ras[b] < 0)
+            continue;
+        bank = &d->bank[b];
+        ras_low = !pin_level(levels, d->map.ras[b]);
+        cas_low = !pin_level(levels, d->map.cas[b]);
+
+        if (ras_low && !bank->ras_low) {
+            if (bank->ras_seen)
+                record(d, RAM_TRC, now - bank->ras_fall);
+            if (bank->ras_rise_seen)
+                record(d, RAM_TRP, now - bank->ras_rise);
+            bank->ras_fall = now;
+            bank->ras_seen = true;
+            bank->cas_in_row = false;
+            bank->row = addr;
+        } else if (!ras_low && bank->ras_low) {
+            if (bank->ras_seen)
+                record(d, RAM_TRAS, now - bank->ras_fall);
+            bank->ras_rise = now;
+            bank->ras_rise_seen = true;
+        }
+        bank->ras_low = ras_low;
+
+        if (cas_low && !bank->cas_low && ras_low) {
+            if (!bank->cas_in_row) {
+                if (bank->ras_seen)
+                    record(d, RAM_TRCD, now - bank->ras_fall);
+            } else {
+                record(d, RAM_TCP, now - bank->cas_rise);
+            }
+            bank->cas_in_row = true;
+            bank->cas_open = true;
+            bank->cas_fall = now;
+            bank->col = addr;
+            bank->written = false;
+            d->last_bank = b;
+            if (we_low) {
+                write_cell(d, b, levels); // Early write: the outputs stay off
+            } else {
+                bank->reading = true;
+                bank->data = d->cells[cell_index(d, b)];
+                bank->valid_ps = MAX(bank->ras_fall + d->spec->trac * 1000ULL, now + d->spec->tcac * 1000ULL);
+            }
+        } else if (!cas_low && bank->cas_low && bank->cas_open) {
+            record(d, RAM_TCAS, now - bank->cas_fall);
+            bank->cas_open = false;
+            bank->cas_rise = now;
+            bank->cas_rise_cycle = cycle;
+        }
+        bank->cas_low = cas_low;
+
+        // Late write: WE# falls while the cell is being read
+        if (bank->cas_open && we_low && !bank->written)
+            write_cell(d, b, levels);
+        // Read data holds until the cycle after CAS# rises
+        if (bank->reading && !bank->cas_open && (cycle > bank->cas_rise_cycle))
+            bank->reading = false;
+    }
+
+    if (!we_low && d->we_low && d->we_wrote)
+        record(d, RAM_TWP, now - d->we_fall);
+    d->we_low = we_low;
+
+    d->drive = 0;
+    d->drive_mask = 0;
+    d->x_mask = 0;
+    for (b = 0; b < DRAM_PINS_BANKS; b++) {
+        bank = &d->bank[b];
+        if ((d->map.ras[b] < 0) || !bank->reading || ((d->map.oe >= 0) && pin_level(levels, d->map.oe)))
+            continue;
+        d->drive_mask = data_mask;
+        // The level of a cycle is what the input synchronizer captures at its end
+        if (pio_sim_time_ps(cycle + 1) >= bank->valid_ps) {
+            d->drive = (uint32_t)bank->data << d->map.dout_base;
+        } else {
+            d->drive = ~((uint32_t)bank->data << d->map.dout_base) & data_mask;
+            d->x_mask = data_mask;
+        }
+    }
+    if (d->drive_mask & oe)
+        d->contention++;
+    *drive = d->drive;
+    *drive_mask = d->drive_mask;
+}
+
+/**
+ * @brief Checks when a read was sampled. Matches pio_sim_device_t.sample.
+ */
+void dram_pins_sample(void *ctx, uint64_t pin_cycle, uint32_t levels)
+{
+    dram_pins_t *d = ctx;
+    dram_pins_bank_t *bank;
+    uint64_t t = pio_sim_time_ps(pin_cycle + 1); // The synchronizer captures at the end of the cycle
+
+    if (d->last_bank < 0)
+        return;
+    bank = &d->bank[d->last_bank];
+    if (bank->written)
+        return; // Writes shift in a dummy bit too
+    if (t < bank->cas_fall) {
+        d->bad_samples++;
+        return;
+    }
+    record(d, RAM_TCAC, t - bank->cas_fall);
+    record(d, RAM_TRAC, t - bank->ras_fall);
+    if ((t < bank->valid_ps) || (!bank->cas_open && (pin_cycle > bank->cas_rise_cycle)))
+        d->bad_samples++;
+}
@@ -0,0 +1,102 @@
+#ifndef DRAM_PINS_H
+#define DRAM_PINS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "ram_timing.h"
+
+// Chips with two RAS# (or RAS# and CAS#) pairs: the piggyback 4132 and 41128
+#define DRAM_PINS_BANKS 2
+
+// Timing parameters measured, indexed by ram_timing_param_t
+#define DRAM_PINS_PARAMS (RAM_TWP + 1)
+
+// Kinds of access measured separately
+typedef enum {
+    DRAM_PHASE_READ,
+    DRAM_PHASE_WRITE,
+    DRAM_PHASE_PAGE_READ,
+    DRAM_PHASE_PAGE_WRITE,
+    DRAM_PHASES
+} dram_phase_t;
+
+/**
+ * @brief The GPIO wired to each pin of the chip, -1 where there is none.
+ */
+typedef struct {
+    int8_t ras[DRAM_PINS_BANKS];
+    int8_t cas[DRAM_PINS_BANKS];
+    int8_t we;
+    int8_t oe;          // Output enable, -1 if the chip has none
+    uint8_t addr_base;  // A0, the rest follow
+    uint8_t addr_bits;
+    uint8_t din_base;   // Data into the chip (D, or DQ0)
+    uint8_t dout_base;  // Data out of the chip (Q, or DQ0)
+    uint8_t data_bits;
+} dram_pins_map_t;
+
+/**
+ * @brief Shortest interval seen for each timing parameter, in picoseconds.
+ */
+typedef struct {
+    uint32_t min_ps[DRAM_PINS_PARAMS]; // UINT32_MAX where never seen
+} dram_pins_stats_t;
+
+/**
+ * @brief RAS#/CAS# state of one bank.
+ */
+typedef struct {
+    bool ras_low;
+    bool cas_low;
+    bool cas_open;      // CAS# fell while RAS# was low, and has not risen
+    bool ras_seen;      // ras_fall holds an edge from this phase
+    bool ras_rise_seen; // ras_rise holds an edge from this phase
+    bool cas_in_row;    // CAS# has fallen since RAS# did
+    uint64_t ras_fall;  // Times of the last edges, in picoseconds
+    uint64_t ras_rise;
+    uint64_t cas_fall;
+    uint64_t cas_rise;
+    uint32_t row;
+    uint32_t col;
+    bool reading;       // Driving read data for the current CAS# cycle
+    bool written;       // The current CAS# cycle wrote the cell
+    uint64_t cas_rise_cycle;
+    uint64_t valid_ps;  // When the read data becomes valid
+    uint8_t data;       // Data being read
+} dram_pins_bank_t;
+
+/**
+ * @brief A DRAM chip modelled at its pins, and the timing seen at them.
+ *
+ * Rows and columns are latched on the falling edges of RAS# and CAS#.
+ * Writes take D on the later of CAS# and WE# falling. Read data is
+ * invalid until both tRAC and tCAC of the datasheet timing have passed,
+ * then held until the cycle after CAS# rises; an early write leaves the
+ * outputs off for the whole cycle.
+ */
+typedef struct {
+    dram_pins_map_t map;
+    const ram_timing_t *spec;
+    uint8_t *cells;
+    dram_pins_bank_t bank[DRAM_PINS_BANKS];
+    bool we_low;
+    bool we_wrote;          // A write happened during this WE# pulse
+    uint64_t we_fall;
+    uint32_t drive;         // Levels put on the data outputs this cycle
+    uint32_t drive_mask;
+    uint32_t x_mask;        // Outputs driven with data that is not valid yet
+    uint8_t phase;
+    dram_pins_stats_t stats[DRAM_PHASES];
+    uint32_t bad_samples;   // Reads sampled outside the valid window
+    uint32_t contention;    // Cycles where the chip and the PIO drove the same pin
+    int8_t last_bank;       // Bank of the last access, for samples
+} dram_pins_t;
+
+// Function prototypes
+bool dram_pins_init(dram_pins_t *d, const dram_pins_map_t *map, const ram_timing_t *spec);
+void dram_pins_free(dram_pins_t *d);
+void dram_pins_set_phase(dram_pins_t *d, dram_phase_t phase);
+void dram_pins_cycle(void *ctx, uint64_t cycle, uint32_t out, uint32_t oe, uint32_t *drive, uint32_t *drive_mask);
+void dram_pins_sample(void *ctx, uint64_t pin_cycle, uint32_t levels);
+
+#endif // DRAM_PINS_H
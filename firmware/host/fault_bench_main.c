@@ -0,0 +1,311 @@
+/*
+ * fault_bench_main.c
+ *
+ * Measures the fault coverage of each test in all_ram_tests against what
+ * it costs. Faults from fault_model.c are injected into the in-memory
+ * chip of mem_pio.c a batch at a time and all_ram_tests runs over each
+ * batch in failure map mode, so every test runs to completion. When the
+ * engine moves on to the next test, the failure map left by the last one
+ * says which faults it caught, and is cleared for the next.
+ *
+ * Usage: fault_bench [-c chip] [-n faults] [-r faults per run] [-s seed]
+ *
+ * The report gives each test's coverage, its accesses and time per run,
+ * the faults only it catches and its coverage of each fault type, then
+ * orders the tests greedily by new faults caught per access: the order
+ * that reaches a given coverage soonest, and the tests that add nothing.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "app_state.h"
+#include "failure_map.h"
+#include "ram_refresh.h"
+#include "mem_pio.h"
+#include "fault_model.h"
+
+// 4116: big enough for realistic topology, small enough for thousands of faults in seconds
+#define FAULT_BENCH_CHIP 2
+#define FAULT_BENCH_FAULTS 2048
+#define FAULT_BENCH_PER_RUN 64
+#define FAULT_BENCH_SEED 42
+
+// Index of the setup phase in the costs, after the tests
+#define FAULT_BENCH_SETUP NUM_RAM_TESTS
+
+/**
+ * @brief Accesses and time spent in one test over every run.
+ */
+typedef struct {
+    uint64_t accesses;
+    uint64_t ns;
+} fault_bench_cost_t;
+
+static fault_bench_cost_t bench_costs[NUM_RAM_TESTS + 1];
+static int bench_phase;
+static uint64_t bench_phase_start_ns;
+static uint64_t bench_phase_start_accesses;
+
+// For every fault injected: its type and the tests that caught it, one bit each
+static uint8_t *fault_types;
+static uint8_t *fault_caught;
+static uint32_t run_first; // Index of the current run's first fault
+
+/**
+ * @brief Returns the host's monotonic clock in nanoseconds.
+ */
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+/**
+ * @brief Charges the cost since the last switch to the current phase and
+ *        the faults in the failure map to its test, then clears the map.
+ */
+static void close_phase(void)
+{
+    uint64_t ns = now_ns();
+    uint64_t accesses = mem_pio_accesses();
+    const fault_t *f;
+    uint32_t i;
+    uint8_t c;
+
+    bench_costs[bench_phase].ns += ns - bench_phase_start_ns;
+    bench_costs[bench_phase].accesses += accesses - bench_phase_start_accesses;
+    bench_phase_start_ns = ns;
+    bench_phase_start_accesses = accesses;
+
+    if (bench_phase == FAULT_BENCH_SETUP)
+        return;
+    for (i = 0; i < fault_count(); i++) {
+        f = fault_get(i);
+        for (c = 0; c < f->num_cells; c++) {
+            if (failure_map_cell(f->cells[c]))
+                fault_caught[run_first + i] |= 1u << bench_phase;
+        }
+    }
+    failure_map_clear();
+}
+
+/**
+ * @brief Switches phase when the engine announces a new test. Called after every access.
+ */
+static void observe(void)
+{
+    int test;
+
+    if (queue_is_empty(&stat_cur_test))
+        return;
+    close_phase();
+    while (queue_try_remove(&stat_cur_test, &test)) {}
+    bench_phase = test;
+}
+
+/**
+ * @brief Runs every test over one batch of faults.
+ *
+ * @param index The chip's index in chip_list.
+ * @param count The number of faults to inject.
+ * @return The number injected.
+ */
+static uint32_t run_batch(uint8_t index, uint32_t count)
+{
+    const mem_chip_t *chip;
+    uint32_t injected;
+    uint32_t i;
+    int test;
+
+    if (!mem_pio_install(index))
+        panic("Out of memory for the cells");
+    chip = chip_list[index];
+    main_menu.sel_line = index;
+    chip->setup_pio(0, 0);
+    injected = fault_inject(chip, count);
+    for (i = 0; i < injected; i++)
+        fault_types[run_first + i] = fault_get(i)->type;
+    mem_pio_set_cell_ops(&fault_cell_ops);
+
+    while (queue_try_remove(&stat_cur_test, &test)) {}
+    bench_phase = FAULT_BENCH_SETUP;
+    bench_phase_start_ns = now_ns();
+    bench_phase_start_accesses = 0;
+    mem_pio_set_observer(observe);
+
+    all_ram_tests(chip->mem_size, chip->bits);
+    ram_refresh_stop();
+    close_phase();
+    mem_pio_set_observer(NULL);
+    chip->teardown_pio();
+
+    mem_pio_remove();
+    fault_clear();
+    return injected;
+}
+
+/**
+ * @brief Counts the faults caught by any of a set of tests and by none of another.
+ *
+ * @param total The number of faults injected.
+ * @param tests Tests, one bit each, any of which must have caught the fault.
+ * @param excluded Tests, one bit each, none of which may have caught it.
+ * @param type A fault type to count only, or NUM_FAULT_TYPES for all.
+ */
+static uint32_t count_caught(uint32_t total, uint8_t tests, uint8_t excluded, int type)
+{
+    uint32_t n = 0;
+    uint32_t i;
+
+    for (i = 0; i < total; i++) {
+        if ((type != NUM_FAULT_TYPES) && (fault_types[i] != type))
+            continue;
+        if ((fault_caught[i] & tests) && !(fault_caught[i] & excluded))
+            n++;
+    }
+    return n;
+}
+
+/**
+ * @brief Prints the coverage and cost of each test.
+ */
+static void report(uint8_t index, uint32_t total, uint32_t runs)
+{
+    const mem_chip_t *chip = chip_list[index];
+    uint8_t all = (1u << NUM_RAM_TESTS) - 1;
+    uint8_t chosen = 0;
+    uint64_t accesses = 0;
+    uint64_t ns = 0;
+    uint32_t injected[NUM_FAULT_TYPES] = {0};
+    uint32_t caught;
+    uint32_t best_caught;
+    double score;
+    double best_score;
+    int best;
+    int type;
+    int t;
+    uint32_t i;
+
+    for (i = 0; i < total; i++)
+        injected[fault_types[i]]++;
+
+    printf("%s: %u addresses x %u bits, %u row bits, %u faults in %u runs\n", chip->chip_name, chip->mem_size,
+           chip->bits, chip->row_bits, total, runs);
+    printf("  %-16s %12s %10s %9s %9s\n", "test", "accesses/run", "ms/run", "caught %", "only %");
+    for (t = 0; t < NUM_RAM_TESTS; t++) {
+        printf("  %-16s %12llu %10.1f %9.1f %9.1f\n", ram_test_names[t],
+               (unsigned long long)(bench_costs[t].accesses / runs), bench_costs[t].ns / 1e6 / runs,
+               100.0 * count_caught(total, 1u << t, 0, NUM_FAULT_TYPES) / total,
+               100.0 * count_caught(total, 1u << t, all & ~(1u << t), NUM_FAULT_TYPES) / total);
+        accesses += bench_costs[t].accesses;
+        ns += bench_costs[t].ns;
+    }
+    printf("  %-16s %12llu %10.1f %9.1f\n", "(all)", (unsigned long long)(accesses / runs), ns / 1e6 / runs,
+           100.0 * count_caught(total, all, 0, NUM_FAULT_TYPES) / total);
+
+    printf("\n  %-16s %6s", "caught %", "faults");
+    for (t = 0; t < NUM_RAM_TESTS; t++)
+        printf(" %16s", ram_test_names[t]);
+    printf(" %6s\n", "any");
+    for (type = 0; type < NUM_FAULT_TYPES; type++) {
+        if (!injected[type])
+            continue;
+        printf("  %-16s %6u", fault_type_names[type], injected[type]);
+        for (t = 0; t < NUM_RAM_TESTS; t++)
+            printf(" %16.1f", 100.0 * count_caught(total, 1u << t, 0, type) / injected[type]);
+        printf(" %6.1f\n", 100.0 * count_caught(total, all, 0, type) / injected[type]);
+    }
+
+    // Greedy order: each step takes the test with the most new faults per access
+    printf("\n  Most new faults per access first:\n");
+    accesses = 0;
+    for (;;) {
+        best = -1;
+        best_score = 0;
+        best_caught = 0;
+        for (t = 0; t < NUM_RAM_TESTS; t++) {
+            if ((chosen & (1u << t)) || !bench_costs[t].accesses)
+                continue;
+            caught = count_caught(total, 1u << t, chosen, NUM_FAULT_TYPES);
+            score = (double)caught / bench_costs[t].accesses;
+            if (caught && (score > best_score)) {
+                best = t;
+                best_score = score;
+                best_caught = caught;
+            }
+        }
+        if (best < 0)
+            break;
+        chosen |= 1u << best;
+        accesses += bench_costs[best].accesses;
+        printf("  %-16s +%5.1f%% to %5.1f%% after %llu accesses\n", ram_test_names[best], 100.0 * best_caught / total,
+               100.0 * count_caught(total, chosen, 0, NUM_FAULT_TYPES) / total,
+               (unsigned long long)(accesses / runs));
+    }
+    for (t = 0; t < NUM_RAM_TESTS; t++) {
+        if (!(chosen & (1u << t)))
+            printf("  %-16s adds nothing\n", ram_test_names[t]);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    int chip = FAULT_BENCH_CHIP;
+    uint32_t total = FAULT_BENCH_FAULTS;
+    uint32_t per_run = FAULT_BENCH_PER_RUN;
+    uint32_t seed = FAULT_BENCH_SEED;
+    uint32_t runs = 0;
+    uint32_t injected;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "c:n:r:s:")) != -1) {
+        switch (opt) {
+        case 'c':
+            chip = atoi(optarg);
+            break;
+        case 'n':
+            total = strtoul(optarg, NULL, 0);
+            break;
+        case 'r':
+            per_run = strtoul(optarg, NULL, 0);
+            break;
+        case 's':
+            seed = strtoul(optarg, NULL, 0);
+            break;
+        default:
+            fprintf(stderr, "Usage: %s [-c chip] [-n faults] [-r faults per run] [-s seed]\n", argv[0]);
+            return 2;
+        }
+    }
+    if ((chip < 0) || (chip >= NUM_CHIPS)) {
+        fprintf(stderr, "There are %u chips\n", NUM_CHIPS);
+        return 2;
+    }
+    if (!total || !per_run) {
+        fprintf(stderr, "Need at least one fault in each run\n");
+        return 2;
+    }
+
+    fault_types = calloc(total, 1);
+    fault_caught = calloc(total, 1);
+    if (!fault_types || !fault_caught)
+        panic("Out of memory for the results");
+    psrand_init_seeds();
+    queue_init(&stat_cur_test, sizeof(int), 2);
+    failure_map_mode = true;
+    fault_seed(seed);
+
+    for (run_first = 0; run_first < total; run_first += injected) {
+        injected = run_batch(chip, MIN(per_run, total - run_first));
+        if (!injected)
+            panic("No room for another fault");
+        runs++;
+    }
+    report(chip, total, runs);
+    return 0;
+}
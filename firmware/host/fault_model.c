@@ -0,0 +1,385 @@
+/*
+ * fault_model.c
+ *
+ * Faults for the in-memory DRAM of mem_pio.c, from the usual memory test
+ * fault models. Faults are placed at random cells of the row/column array
+ * (addr = col << row_bits | row, less any bank bits at the bottom of the
+ * row), with coupling and pattern faults between cells that are physical
+ * neighbours and address decoder faults between addresses one address line
+ * apart. No two faults share or border a cell, so every failing read can be
+ * charged to exactly one of them.
+ */
+
+#include <stdlib.h>
+#include "pico/stdlib.h"
+#include "fault_model.h"
+#include "ram_refresh.h"
+
+// Random placements tried for one fault before the array is considered full
+#define FAULT_PLACE_TRIES 1000
+
+const char *fault_type_names[NUM_FAULT_TYPES] = {"stuck-at", "transition", "coupling-idem", "coupling-inv",
+                                                 "coupling-state", "addr-decoder", "NPSF", "retention"};
+
+static fault_t *faults;
+static uint32_t num_faults;
+
+// Fault owning each cell, and the retention fault in each row, as index + 1
+static uint16_t *cell_owner;
+static uint16_t *row_retention;
+
+static uint32_t fault_mem_size;
+static uint32_t fault_bits;
+static uint8_t fault_row_bits;
+static uint8_t fault_bank_bits;
+static uint32_t fault_refresh_us;
+static uint32_t fault_rng = 1;
+
+/**
+ * @brief Returns the next number from a xorshift32 generator kept apart from the tests' one.
+ */
+static uint32_t fault_rand(void)
+{
+    fault_rng ^= fault_rng << 13;
+    fault_rng ^= fault_rng >> 17;
+    fault_rng ^= fault_rng << 5;
+    return fault_rng;
+}
+
+/**
+ * @brief Seeds the placement of the faults.
+ */
+void fault_seed(uint32_t seed)
+{
+    fault_rng = seed ? seed : 1;
+}
+
+/**
+ * @brief Finds the cell next to another in the array.
+ *
+ * Neighbours share a die or RAS# line, so only the physical row and the
+ * column change.
+ *
+ * @param addr The cell.
+ * @param dir 0 for the row above, 1 below, 2 for the column to the left, 3 to the right.
+ * @param neighbour Receives the neighbour's address.
+ * @return False at the edge of the array.
+ */
+static bool neighbour_of(uint32_t addr, uint8_t dir, uint32_t *neighbour)
+{
+    uint32_t rows = 1u << (fault_row_bits - fault_bank_bits);
+    uint32_t cols = fault_mem_size >> fault_row_bits;
+    uint32_t bank = addr & ((1u << fault_bank_bits) - 1);
+    uint32_t row = (addr >> fault_bank_bits) & (rows - 1);
+    uint32_t col = addr >> fault_row_bits;
+
+    switch (dir) {
+    case 0:
+        if (row == 0)
+            return false;
+        row--;
+        break;
+    case 1:
+        if (row == rows - 1)
+            return false;
+        row++;
+        break;
+    case 2:
+        if (col == 0)
+            return false;
+        col--;
+        break;
+    default:
+        if (col == cols - 1)
+            return false;
+        col++;
+        break;
+    }
+    *neighbour = (col << fault_row_bits) | (row << fault_bank_bits) | bank;
+    return true;
+}
+
+/**
+ * @brief Checks that none of a fault's cells or their neighbours belong to another fault.
+ */
+static bool cells_free(const fault_t *f)
+{
+    uint32_t n;
+    uint8_t i;
+    uint8_t dir;
+
+    for (i = 0; i < f->num_cells; i++) {
+        if (cell_owner[f->cells[i]])
+            return false;
+        for (dir = 0; dir < 4; dir++) {
+            if (neighbour_of(f->cells[i], dir, &n) && cell_owner[n])
+                return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Picks random cells and parameters for a fault of the given type.
+ *
+ * @return False if the cells picked cannot hold the fault.
+ */
+static bool place(fault_type_t type, fault_t *f)
+{
+    uint32_t addr_bits = 0;
+    uint8_t i;
+
+    while ((1u << addr_bits) < fault_mem_size)
+        addr_bits++;
+
+    f->type = type;
+    f->cells[0] = fault_rand() % fault_mem_size;
+    f->num_cells = 1;
+    f->bit = fault_rand() % fault_bits;
+    f->value = fault_rand() & 1;
+    f->trigger = fault_rand() & 1;
+    f->also = false;
+    f->retention_us = 0;
+    f->row_opened_us = time_us_64();
+
+    switch (type) {
+    case FAULT_COUPLING_IDEMPOTENT:
+    case FAULT_COUPLING_INVERSION:
+    case FAULT_COUPLING_STATE:
+        if (!neighbour_of(f->cells[0], fault_rand() % 4, &f->cells[1]))
+            return false;
+        f->num_cells = 2;
+        break;
+    case FAULT_ADDRESS_DECODER:
+        // A shorted or open address line selects the address one line away
+        f->cells[1] = f->cells[0] ^ (1u << (fault_rand() % addr_bits));
+        f->num_cells = 2;
+        f->also = fault_rand() & 1;
+        break;
+    case FAULT_NPSF:
+        for (i = 0; i < 4; i++) {
+            if (!neighbour_of(f->cells[0], i, &f->cells[1 + i]))
+                return false;
+        }
+        f->num_cells = 5;
+        f->trigger = fault_rand() & 0xf;
+        break;
+    case FAULT_RETENTION:
+        // Weak enough to fail without refresh, strong enough to survive it
+        if (row_retention[f->cells[0] & ((1u << fault_row_bits) - 1)])
+            return false;
+        f->retention_us = fault_refresh_us + fault_rand() % (3 * fault_refresh_us);
+        break;
+    default:
+        break;
+    }
+    return cells_free(f);
+}
+
+/**
+ * @brief Injects faults at random cells, an equal number of each type.
+ *
+ * Any faults injected before are cleared first. The cells start fault-free
+ * in content; install the faults with mem_pio_set_cell_ops(&fault_cell_ops).
+ *
+ * @param chip The chip, for its geometry.
+ * @param count The number of faults wanted.
+ * @return The number injected, fewer than asked if the array filled up.
+ */
+uint32_t fault_inject(const mem_chip_t *chip, uint32_t count)
+{
+    uint32_t mem_size = chip->mem_size;
+    uint8_t row_bits = chip->row_bits;
+    fault_t *f;
+    uint32_t tries;
+    uint8_t i;
+
+    fault_clear();
+    count = MIN(count, UINT16_MAX);
+    fault_mem_size = mem_size;
+    fault_bits = chip->bits;
+    fault_row_bits = row_bits;
+    fault_bank_bits = chip->bank_bits;
+    fault_refresh_us = ram_refresh_period_us(chip);
+    faults = malloc(count * sizeof(fault_t));
+    cell_owner = calloc(mem_size, sizeof(uint16_t));
+    row_retention = calloc(1u << row_bits, sizeof(uint16_t));
+    if (!faults || !cell_owner || !row_retention)
+        panic("Out of memory for the faults");
+
+    while (num_faults < count) {
+        f = &faults[num_faults];
+        for (tries = 0; tries < FAULT_PLACE_TRIES; tries++) {
+            if (place(num_faults % NUM_FAULT_TYPES, f))
+                break;
+        }
+        if (tries == FAULT_PLACE_TRIES)
+            break;
+
+        num_faults++;
+        for (i = 0; i < f->num_cells; i++)
+            cell_owner[f->cells[i]] = num_faults;
+        if (f->type == FAULT_RETENTION)
+            row_retention[f->cells[0] & ((1u << row_bits) - 1)] = num_faults;
+    }
+    return num_faults;
+}
+
+/**
+ * @brief Removes every fault.
+ */
+void fault_clear(void)
+{
+    free(faults);
+    free(cell_owner);
+    free(row_retention);
+    faults = NULL;
+    cell_owner = NULL;
+    row_retention = NULL;
+    num_faults = 0;
+}
+
+/**
+ * @brief Returns the number of faults injected.
+ */
+uint32_t fault_count(void)
+{
+    return num_faults;
+}
+
+/**
+ * @brief Returns one of the faults injected.
+ */
+const fault_t *fault_get(uint32_t index)
+{
+    return &faults[index];
+}
+
+// Cell operations
+
+static inline uint8_t get_bit(uint8_t data, uint8_t bit)
+{
+    return (data >> bit) & 1;
+}
+
+static inline uint8_t set_bit(uint8_t data, uint8_t bit, uint8_t value)
+{
+    return (data & ~(1u << bit)) | (value << bit);
+}
+
+/**
+ * @brief Opens the row of an address, first letting a weak cell in it decay.
+ */
+static void open_row(uint8_t *cells, uint32_t addr)
+{
+    uint16_t owner = row_retention[addr & ((1u << fault_row_bits) - 1)];
+    uint64_t now;
+    fault_t *f;
+
+    if (!owner)
+        return;
+    f = &faults[owner - 1];
+    now = time_us_64();
+    if (now - f->row_opened_us > f->retention_us)
+        cells[f->cells[0]] = set_bit(cells[f->cells[0]], f->bit, f->value);
+    f->row_opened_us = now;
+}
+
+/**
+ * @brief Checks whether a fault's forcing condition holds on the victim.
+ */
+static bool victim_forced(const uint8_t *cells, const fault_t *f)
+{
+    uint8_t i;
+
+    if (f->type == FAULT_COUPLING_STATE)
+        return get_bit(cells[f->cells[1]], f->bit) == f->trigger;
+    for (i = 0; i < 4; i++) {
+        if (get_bit(cells[f->cells[1 + i]], f->bit) != ((f->trigger >> i) & 1))
+            return false;
+    }
+    return true;
+}
+
+static uint8_t fault_read(uint8_t *cells, uint32_t addr)
+{
+    uint16_t owner = cell_owner[addr];
+    const fault_t *f;
+
+    open_row(cells, addr);
+    if (!owner)
+        return cells[addr];
+    f = &faults[owner - 1];
+    if (addr != f->cells[0])
+        return cells[addr];
+
+    switch (f->type) {
+    case FAULT_STUCK_AT:
+        return set_bit(cells[addr], f->bit, f->value);
+    case FAULT_ADDRESS_DECODER:
+        // Two cells driving the data line at once read as their wired AND
+        return f->also ? (cells[addr] & cells[f->cells[1]]) : cells[f->cells[1]];
+    case FAULT_COUPLING_STATE:
+    case FAULT_NPSF:
+        if (victim_forced(cells, f))
+            cells[addr] = set_bit(cells[addr], f->bit, f->value);
+        return cells[addr];
+    default:
+        return cells[addr];
+    }
+}
+
+static void fault_write(uint8_t *cells, uint32_t addr, uint8_t data)
+{
+    uint16_t owner = cell_owner[addr];
+    const fault_t *f;
+    uint32_t victim;
+    uint8_t old;
+
+    open_row(cells, addr);
+    if (!owner) {
+        cells[addr] = data;
+        return;
+    }
+    f = &faults[owner - 1];
+    victim = f->cells[0];
+    old = get_bit(cells[addr], f->bit);
+
+    switch (f->type) {
+    case FAULT_STUCK_AT:
+        cells[addr] = set_bit(data, f->bit, f->value);
+        break;
+    case FAULT_TRANSITION:
+        if ((old != f->value) && (get_bit(data, f->bit) == f->value))
+            data = set_bit(data, f->bit, old);
+        cells[addr] = data;
+        break;
+    case FAULT_COUPLING_IDEMPOTENT:
+    case FAULT_COUPLING_INVERSION:
+        cells[addr] = data;
+        if ((addr != victim) && (old != get_bit(data, f->bit)) && (get_bit(data, f->bit) == f->trigger)) {
+            if (f->type == FAULT_COUPLING_IDEMPOTENT)
+                cells[victim] = set_bit(cells[victim], f->bit, f->value);
+            else
+                cells[victim] ^= 1u << f->bit;
+        }
+        break;
+    case FAULT_ADDRESS_DECODER:
+        if ((addr == victim) && f->also)
+            cells[victim] = data;
+        cells[(addr == victim) ? f->cells[1] : addr] = data;
+        break;
+    case FAULT_COUPLING_STATE:
+    case FAULT_NPSF:
+        cells[addr] = data;
+        if ((addr == victim) && victim_forced(cells, f))
+            cells[addr] = set_bit(data, f->bit, f->value);
+        break;
+    default:
+        cells[addr] = data;
+        break;
+    }
+}
+
+// Cell operations that apply the faults injected
+const mem_pio_cell_ops_t fault_cell_ops = {fault_read, fault_write};
@@ -0,0 +1,56 @@
+#ifndef FAULT_MODEL_H
+#define FAULT_MODEL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "mem_pio.h"
+#include "app_state.h"
+
+// Most cells a single fault involves: an NPSF victim and its four neighbours
+#define FAULT_MAX_CELLS 5
+
+/**
+ * @brief The kinds of fault that can be injected.
+ */
+typedef enum {
+    FAULT_STUCK_AT,           // The cell always holds `value`
+    FAULT_TRANSITION,         // The cell cannot make the transition to `value`
+    FAULT_COUPLING_IDEMPOTENT, // A `trigger` transition of the aggressor forces the victim to `value`
+    FAULT_COUPLING_INVERSION, // A `trigger` transition of the aggressor inverts the victim
+    FAULT_COUPLING_STATE,     // The victim is forced to `value` while the aggressor holds `trigger`
+    FAULT_ADDRESS_DECODER,    // The victim's address selects the aggressor, instead of or as well as the victim
+    FAULT_NPSF,               // The victim is forced to `value` while its neighbours hold the pattern in `trigger`
+    FAULT_RETENTION,          // The cell decays to `value` when its row goes unopened for `retention_us`
+    NUM_FAULT_TYPES
+} fault_type_t;
+
+/**
+ * @brief One injected fault.
+ *
+ * cells[0] is the victim. For coupling and address decoder faults cells[1]
+ * is the aggressor; for NPSF cells[1..4] are the neighbours above, below,
+ * left and right of the victim in the cell array.
+ */
+typedef struct {
+    fault_type_t type;
+    uint32_t cells[FAULT_MAX_CELLS];
+    uint8_t num_cells;
+    uint8_t bit;           // Data bit the fault acts on
+    uint8_t value;         // Value the victim is forced or decays to, or the failing transition
+    uint8_t trigger;       // Aggressor transition or state, or NPSF neighbour pattern
+    bool also;             // Address decoder fault accesses the victim as well as the aggressor
+    uint32_t retention_us; // Retention faults only
+    uint64_t row_opened_us;
+} fault_t;
+
+extern const char *fault_type_names[NUM_FAULT_TYPES];
+extern const mem_pio_cell_ops_t fault_cell_ops;
+
+// Function prototypes
+void fault_seed(uint32_t seed);
+uint32_t fault_inject(const mem_chip_t *chip, uint32_t count);
+void fault_clear(void);
+uint32_t fault_count(void);
+const fault_t *fault_get(uint32_t index);
+
+#endif // FAULT_MODEL_H
@@ -0,0 +1,211 @@
+/*
+ * host_dma.c
+ *
+ * DMA channels run in software for host builds. A channel paced by a PIO
+ * DREQ moves a word only when the SDK FIFO calls say there is room or
+ * data, so it works over any PIO backend: the cycle-accurate simulator or
+ * the in-memory DRAM. Transfers progress when they are started and
+ * whenever a channel is polled or waited on, which is the only time the
+ * single host thread could observe them.
+ */
+
+#include <string.h>
+#include "hardware/dma.h"
+#include "hardware/pio.h"
+
+// Rounds without a word moving before a wait gives up on a channel
+#define HOST_DMA_STALL_LIMIT 1000000
+
+/**
+ * @brief The state of one channel.
+ */
+typedef struct {
+    bool claimed;
+    dma_channel_config config;
+    volatile uint32_t *write_addr;
+    const volatile uint32_t *read_addr;
+    uint32_t remaining;
+} host_dma_channel_t;
+
+static host_dma_channel_t host_dma_channels[NUM_DMA_CHANNELS];
+
+// Sniffer: the channel it watches (-1 for none) and its CRC32 accumulator
+static int sniff_channel = -1;
+static uint32_t sniff_crc;
+
+/**
+ * @brief Adds one word to the sniffer's CRC32 (polynomial 0x04c11db7, MSB first).
+ *
+ * The bytes are taken in memory order. Results are only ever compared with
+ * other results from the sniffer, so matching the hardware bit for bit is
+ * not needed.
+ */
+static uint32_t crc32_word(uint32_t crc, uint32_t word)
+{
+    uint8_t byte;
+    uint8_t bit;
+
+    for (byte = 0; byte < 4; byte++) {
+        crc ^= ((word >> (8 * byte)) & 0xff) << 24;
+        for (bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x80000000) ? (crc << 1) ^ 0x04c11db7 : crc << 1;
+        }
+    }
+    return crc;
+}
+
+/**
+ * @brief Finds the PIO FIFO register an address points at.
+ *
+ * @param addr The address.
+ * @param pio Receives the PIO block.
+ * @param sm Receives the state machine.
+ * @param tx Receives true for a TX FIFO, false for an RX FIFO.
+ * @return False if the address is ordinary memory.
+ */
+static bool fifo_at(const volatile void *addr, PIO *pio, uint *sm, bool *tx)
+{
+    uint block;
+    uint i;
+
+    for (block = 0; block < NUM_PIOS; block++) {
+        for (i = 0; i < NUM_PIO_STATE_MACHINES; i++) {
+            if ((addr == &pio_host_hw[block].txf[i]) || (addr == &pio_host_hw[block].rxf[i])) {
+                *pio = &pio_host_hw[block];
+                *sm = i;
+                *tx = (addr == &pio_host_hw[block].txf[i]);
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Checks whether a channel's DREQ lets it move a word now.
+ */
+static bool dreq_ready(uint dreq)
+{
+    PIO pio;
+    uint sm;
+
+    if (dreq == DREQ_FORCE)
+        return true;
+    pio = &pio_host_hw[dreq / 8];
+    sm = dreq % 4;
+    return ((dreq % 8) < 4) ? !pio_sm_is_tx_fifo_full(pio, sm) : !pio_sm_is_rx_fifo_empty(pio, sm);
+}
+
+/**
+ * @brief Moves one word on a channel if its DREQ allows.
+ *
+ * @return True if a word moved.
+ */
+static bool transfer_one(uint channel)
+{
+    host_dma_channel_t *c = &host_dma_channels[channel];
+    uint32_t word;
+    PIO pio;
+    uint sm;
+    bool tx;
+
+    if (!c->remaining || !dreq_ready(c->config.dreq))
+        return false;
+
+    if (fifo_at(c->read_addr, &pio, &sm, &tx) && !tx)
+        word = pio_sm_get(pio, sm);
+    else
+        word = *c->read_addr;
+    if (fifo_at(c->write_addr, &pio, &sm, &tx) && tx)
+        pio_sm_put(pio, sm, word);
+    else
+        *c->write_addr = word;
+
+    if (c->config.sniff && (sniff_channel == (int)channel))
+        sniff_crc = crc32_word(sniff_crc, word);
+    if (c->config.read_increment)
+        c->read_addr++;
+    if (c->config.write_increment)
+        c->write_addr++;
+    c->remaining--;
+    return true;
+}
+
+/**
+ * @brief Runs every busy channel until none of them can move a word.
+ */
+static void pump(void)
+{
+    bool moved;
+    uint i;
+
+    do {
+        moved = false;
+        for (i = 0; i < NUM_DMA_CHANNELS; i++) {
+            moved |= transfer_one(i);
+        }
+    } while (moved);
+}
+
+int dma_claim_unused_channel(bool required)
+{
+    uint i;
+
+    for (i = 0; i < NUM_DMA_CHANNELS; i++) {
+        if (!host_dma_channels[i].claimed) {
+            host_dma_channels[i].claimed = true;
+            return (int)i;
+        }
+    }
+    if (required)
+        panic("No DMA channels are available");
+    return -1;
+}
+
+void dma_channel_configure(uint channel, const dma_channel_config *config, volatile void *write_addr,
+                           const volatile void *read_addr, uint transfer_count, bool trigger)
+{
+    host_dma_channel_t *c = &host_dma_channels[channel];
+
+    if (config->size != DMA_SIZE_32)
+        panic("Host DMA only moves 32-bit words");
+    c->config = *config;
+    c->write_addr = write_addr;
+    c->read_addr = read_addr;
+    c->remaining = trigger ? transfer_count : 0;
+    if (trigger)
+        pump();
+}
+
+bool dma_channel_is_busy(uint channel)
+{
+    pump();
+    return host_dma_channels[channel].remaining != 0;
+}
+
+void dma_channel_wait_for_finish_blocking(uint channel)
+{
+    uint32_t stalls = 0;
+
+    while (dma_channel_is_busy(channel)) {
+        if (++stalls > HOST_DMA_STALL_LIMIT)
+            panic("DMA channel %u never finished", channel);
+    }
+}
+
+void dma_sniffer_enable(uint channel, uint mode, bool force_channel_enable)
+{
+    sniff_channel = (int)channel;
+    if (force_channel_enable)
+        host_dma_channels[channel].config.sniff = true;
+}
+
+void dma_sniffer_set_data_accumulator(uint32_t seed_value)
+{
+    sniff_crc = seed_value;
+}
+
+uint32_t dma_sniffer_get_data_accumulator(void)
+{
+    return sniff_crc;
+}
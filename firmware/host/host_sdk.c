@@ -0,0 +1,187 @@
+/*
+ * host_sdk.c
+ *
+ * The parts of the Pico SDK the firmware calls outside of the PIO, for
+ * builds that run on the host. Time is the host's monotonic clock, the
+ * pads and the voltage regulator do nothing, and queues are plain ring
+ * buffers used from a single thread.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+#include <time.h>
+#include "pico/stdlib.h"
+#include "pico/multicore.h"
+#include "pico/util/queue.h"
+#include "hardware/clocks.h"
+#include "hardware/vreg.h"
+
+// Crystal the PLL is referenced to, as on the Pico 2
+#define HOST_XOSC_KHZ 12000
+
+static uint32_t sys_clock_khz = 300000;
+
+void panic(const char *fmt, ...)
+{
+    va_list args;
+
+    va_start(args, fmt);
+    fputs("panic: ", stderr);
+    vfprintf(stderr, fmt, args);
+    fputc('\n', stderr);
+    va_end(args);
+    exit(2);
+}
+
+// Time
+
+uint64_t time_us_64(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+uint32_t time_us_32(void)
+{
+    return (uint32_t)time_us_64();
+}
+
+void sleep_us(uint64_t us)
+{
+    struct timespec ts = { .tv_sec = us / 1000000, .tv_nsec = (us % 1000000) * 1000 };
+
+    nanosleep(&ts, NULL);
+}
+
+void sleep_ms(uint32_t ms)
+{
+    sleep_us((uint64_t)ms * 1000);
+}
+
+void busy_wait_us_32(uint32_t us)
+{
+    sleep_us(us);
+}
+
+// GPIO
+
+void gpio_init(uint gpio) {}
+void gpio_set_dir(uint gpio, bool out) {}
+void gpio_put(uint gpio, bool value) {}
+void gpio_set_slew_rate(uint gpio, enum gpio_slew_rate slew) {}
+void gpio_set_drive_strength(uint gpio, enum gpio_drive_strength drive) {}
+
+bool gpio_get(uint gpio)
+{
+    return true; // Buttons have pull-ups and are never pressed
+}
+
+// Clocks
+
+uint32_t clock_get_hz(enum clock_index clk_index)
+{
+    return (clk_index == clk_ref) ? HOST_XOSC_KHZ * 1000 : sys_clock_khz * 1000;
+}
+
+/**
+ * @brief Finds PLL settings for a system clock, searching as the SDK does.
+ *
+ * Prefers the highest VCO frequency, then the largest first post divider.
+ */
+bool check_sys_clock_khz(uint32_t freq_khz, uint *vco_freq_out, uint *post_div1_out, uint *post_div2_out)
+{
+    uint fbdiv, postdiv1, postdiv2;
+    uint32_t vco_khz;
+
+    for (fbdiv = 320; fbdiv >= 16; fbdiv--) {
+        vco_khz = fbdiv * HOST_XOSC_KHZ;
+        if ((vco_khz < 750000) || (vco_khz > 1600000))
+            continue;
+        for (postdiv1 = 7; postdiv1 >= 1; postdiv1--) {
+            for (postdiv2 = postdiv1; postdiv2 >= 1; postdiv2--) {
+                if (vco_khz == freq_khz * postdiv1 * postdiv2) {
+                    *vco_freq_out = vco_khz * 1000;
+                    *post_div1_out = postdiv1;
+                    *post_div2_out = postdiv2;
+                    return true;
+                }
+            }
+        }
+    }
+    return false;
+}
+
+bool set_sys_clock_khz(uint32_t freq_khz, bool required)
+{
+    uint vco, postdiv1, postdiv2;
+
+    if (!check_sys_clock_khz(freq_khz, &vco, &postdiv1, &postdiv2)) {
+        if (required)
+            panic("System clock of %u kHz cannot be achieved", freq_khz);
+        return false;
+    }
+    sys_clock_khz = freq_khz;
+    return true;
+}
+
+void vreg_set_voltage(enum vreg_voltage voltage) {}
+
+// Multicore
+
+void multicore_reset_core1(void) {}
+
+void multicore_launch_core1(void (*entry)(void))
+{
+    panic("No second core on the host");
+}
+
+// Queues
+
+void queue_init(queue_t *q, uint element_size, uint element_count)
+{
+    q->data = calloc(element_count, element_size);
+    if (!q->data)
+        panic("Out of memory for a queue");
+    q->element_size = element_size;
+    q->element_count = element_count;
+    q->rptr = 0;
+    q->count = 0;
+}
+
+bool queue_try_add(queue_t *q, const void *data)
+{
+    if (q->count == q->element_count)
+        return false;
+    memcpy(q->data + ((q->rptr + q->count) % q->element_count) * q->element_size, data, q->element_size);
+    q->count++;
+    return true;
+}
+
+bool queue_try_remove(queue_t *q, void *data)
+{
+    if (q->count == 0)
+        return false;
+    memcpy(data, q->data + q->rptr * q->element_size, q->element_size);
+    q->rptr = (q->rptr + 1) % q->element_count;
+    q->count--;
+    return true;
+}
+
+void queue_add_blocking(queue_t *q, const void *data)
+{
+    uint8_t oldest[q->element_size];
+
+    if (q->count == q->element_count)
+        queue_try_remove(q, oldest); // Nothing else could ever empty it
+    queue_try_add(q, data);
+}
+
+void queue_remove_blocking(queue_t *q, void *data)
+{
+    if (!queue_try_remove(q, data))
+        panic("Waiting on an empty queue that nothing will fill");
+}
@@ -0,0 +1,300 @@
+/*
+ * mem_pio.c
+ *
+ * A DRAM chip held in host memory behind the SDK's PIO API, so the test
+ * engine runs at host speed with every access still going through the
+ * FIFOs. mem_pio_install swaps an entry of chip_list for a chip of the
+ * same geometry whose routines stream commands the way the real ones do;
+ * a single state machine executes each command word the moment it has
+ * room in its RX FIFO, and pushes the result. The cells are plain memory
+ * unless cell operations are set, which is how faults are modelled. The
+ * rest of the PIO API accepts anything and does nothing.
+ */
+
+#include <stdlib.h>
+#include "mem_pio.h"
+#include "app_state.h"
+#include "ram_stream.h"
+
+#define MEM_PIO_FIFO_DEPTH 4
+
+// Command word: bit 0 RAM_CMD_PAGE, bit 1 write, bits 2-5 data, bits 6-23 address
+#define MEM_PIO_CMD_WRITE 2
+#define MEM_PIO_DATA_SHIFT 2
+#define MEM_PIO_ADDR_SHIFT 6
+
+pio_hw_t pio_host_hw[NUM_PIOS];
+
+// The chip being emulated, the entry of chip_list it replaced and its cells
+static mem_chip_t mem_pio_chip;
+static const mem_chip_t *mem_pio_replaced;
+static uint8_t mem_pio_index;
+static uint8_t *mem_pio_cells;
+static uint32_t mem_pio_addr_mask;
+static uint32_t mem_pio_data_mask;
+
+// FIFOs of the one state machine that executes commands
+static uint32_t tx[MEM_PIO_FIFO_DEPTH];
+static uint8_t tx_head, tx_level;
+static uint32_t rx[MEM_PIO_FIFO_DEPTH];
+static uint8_t rx_head, rx_level;
+
+static uint64_t mem_pio_access_count;
+static void (*mem_pio_observer)(void);
+static const mem_pio_cell_ops_t *mem_pio_cell_ops;
+
+/**
+ * @brief Executes queued commands until the TX FIFO is empty or the RX FIFO is full.
+ */
+static void run(void)
+{
+    uint32_t cmd;
+    uint32_t addr;
+    uint32_t result = 0;
+
+    while (tx_level && (rx_level < MEM_PIO_FIFO_DEPTH)) {
+        cmd = tx[tx_head];
+        tx_head = (tx_head + 1) % MEM_PIO_FIFO_DEPTH;
+        tx_level--;
+
+        addr = (cmd >> MEM_PIO_ADDR_SHIFT) & mem_pio_addr_mask;
+        if (cmd & MEM_PIO_CMD_WRITE) {
+            if (mem_pio_cell_ops)
+                mem_pio_cell_ops->write(mem_pio_cells, addr, (cmd >> MEM_PIO_DATA_SHIFT) & mem_pio_data_mask);
+            else
+                mem_pio_cells[addr] = (cmd >> MEM_PIO_DATA_SHIFT) & mem_pio_data_mask;
+            result = 0; // Writes push a dummy result
+        } else {
+            result = mem_pio_cell_ops ? mem_pio_cell_ops->read(mem_pio_cells, addr) : mem_pio_cells[addr];
+        }
+        rx[(rx_head + rx_level) % MEM_PIO_FIFO_DEPTH] = result;
+        rx_level++;
+        mem_pio_access_count++;
+        if (mem_pio_observer)
+            mem_pio_observer();
+    }
+}
+
+// The emulated chip's routines, shaped like those of the real chips
+
+static inline uint32_t mem_pio_encode(int addr, int data, bool write)
+{
+    return (write ? MEM_PIO_CMD_WRITE : 0) |
+           ((data & mem_pio_data_mask) << MEM_PIO_DATA_SHIFT) |
+           (((uint32_t)addr & mem_pio_addr_mask) << MEM_PIO_ADDR_SHIFT);
+}
+
+static int mem_pio_ram_read(int addr)
+{
+    pio_sm_put(pio, sm, mem_pio_encode(addr, 0, false));
+    while (pio_sm_is_rx_fifo_empty(pio, sm)) {}
+    return pio_sm_get(pio, sm);
+}
+
+static void mem_pio_ram_write(int addr, int data)
+{
+    pio_sm_put(pio, sm, mem_pio_encode(addr, data, true));
+    while (pio_sm_is_rx_fifo_empty(pio, sm)) {}
+    pio_sm_get(pio, sm);
+}
+
+static void mem_pio_ram_read_block(int addr, uint32_t *data, uint32_t count)
+{
+    ram_stream_read_run(mem_pio_encode, addr, data, count);
+}
+
+static void mem_pio_ram_write_block(int addr, const uint32_t *data, uint32_t count)
+{
+    ram_stream_write_run(mem_pio_encode, addr, data, count);
+}
+
+static void mem_pio_ram_read_page(int addr, uint32_t *data, uint32_t count)
+{
+    ram_stream_read_page_run(mem_pio_encode, addr, 1 << mem_pio_chip.row_bits, data, count,
+                             mem_pio_chip.page_mode);
+}
+
+static void mem_pio_ram_write_page(int addr, const uint32_t *data, uint32_t count)
+{
+    ram_stream_write_page_run(mem_pio_encode, addr, 1 << mem_pio_chip.row_bits, data, count,
+                              mem_pio_chip.page_mode);
+}
+
+static void mem_pio_setup_pio(uint speed_grade, uint variant)
+{
+    pio = pio0;
+    sm = 0;
+    offset = 0;
+    tx_level = rx_level = 0;
+}
+
+static void mem_pio_teardown_pio()
+{
+}
+
+/**
+ * @brief Replaces a chip in chip_list with one of the same geometry held in memory.
+ *
+ * Any chip installed before is removed first. Every cell starts at 0.
+ *
+ * @param index The entry of chip_list to replace.
+ * @return False if the cells could not be allocated.
+ */
+bool mem_pio_install(uint8_t index)
+{
+    const mem_chip_t *chip = chip_list[index];
+
+    mem_pio_remove();
+    mem_pio_cells = calloc(chip->mem_size, 1);
+    if (!mem_pio_cells)
+        return false;
+    mem_pio_addr_mask = chip->mem_size - 1; // Every supported size is a power of two
+    mem_pio_data_mask = (1u << chip->bits) - 1;
+
+    mem_pio_chip = *chip; // Geometry, names and timing; the speed names are not needed
+    mem_pio_chip.setup_pio = mem_pio_setup_pio;
+    mem_pio_chip.teardown_pio = mem_pio_teardown_pio;
+    mem_pio_chip.ram_read = mem_pio_ram_read;
+    mem_pio_chip.ram_write = mem_pio_ram_write;
+    mem_pio_chip.ram_encode = mem_pio_encode;
+    mem_pio_chip.ram_read_block = mem_pio_ram_read_block;
+    mem_pio_chip.ram_write_block = mem_pio_ram_write_block;
+    mem_pio_chip.ram_read_page = mem_pio_ram_read_page;
+    mem_pio_chip.ram_write_page = mem_pio_ram_write_page;
+
+    mem_pio_replaced = chip;
+    mem_pio_index = index;
+    chip_list[index] = &mem_pio_chip;
+    mem_pio_access_count = 0;
+    return true;
+}
+
+/**
+ * @brief Puts back the chip replaced by mem_pio_install and frees the cells.
+ *
+ * Any cell operations are dropped with the cells.
+ */
+void mem_pio_remove(void)
+{
+    mem_pio_cell_ops = NULL;
+    if (!mem_pio_replaced)
+        return;
+    chip_list[mem_pio_index] = mem_pio_replaced;
+    mem_pio_replaced = NULL;
+    free(mem_pio_cells);
+    mem_pio_cells = NULL;
+}
+
+/**
+ * @brief Returns the number of commands executed since the chip was installed.
+ */
+uint64_t mem_pio_accesses(void)
+{
+    return mem_pio_access_count;
+}
+
+/**
+ * @brief Sets a function called after every command is executed, or NULL for none.
+ */
+void mem_pio_set_observer(void (*observer)(void))
+{
+    mem_pio_observer = observer;
+}
+
+/**
+ * @brief Sets the functions that read and write the cells, or NULL for plain memory.
+ *
+ * Data passed to and returned from the operations holds only the chip's
+ * data bits.
+ */
+void mem_pio_set_cell_ops(const mem_pio_cell_ops_t *ops)
+{
+    mem_pio_cell_ops = ops;
+}
+
+// PIO API. Only state machine 0 of pio0 executes anything.
+
+bool pio_claim_free_sm_and_add_program_for_gpio_range(const struct pio_program *program, PIO *pio, uint *sm,
+                                                      uint *offset, uint gpio_base, uint gpio_count,
+                                                      bool set_gpio_base)
+{
+    *pio = pio0;
+    *sm = 0;
+    *offset = 0;
+    return true;
+}
+
+void pio_remove_program_and_unclaim_sm(const struct pio_program *program, PIO pio, uint sm, uint offset) {}
+void pio_gpio_init(PIO pio, uint pin) {}
+void pio_sm_init(PIO pio, uint sm, uint initial_pc, const pio_sm_config *config) {}
+void pio_sm_set_enabled(PIO pio, uint sm, bool enabled) {}
+void pio_sm_set_consecutive_pindirs(PIO pio, uint sm, uint pin_base, uint pin_count, bool is_out) {}
+void pio_sm_set_clkdiv(PIO pio, uint sm, float div) {}
+void pio_sm_restart(PIO pio, uint sm) {}
+void pio_sm_exec(PIO pio, uint sm, uint instr) {}
+
+void pio_sm_clear_fifos(PIO pio, uint sm)
+{
+    tx_level = 0;
+    rx_level = 0;
+}
+
+void pio_sm_put(PIO pio, uint sm, uint32_t data)
+{
+    // The real FIFO drops a word written while full; nothing here relies on that
+    if (tx_level >= MEM_PIO_FIFO_DEPTH)
+        panic("mem_pio: TX FIFO overflowed");
+    tx[(tx_head + tx_level) % MEM_PIO_FIFO_DEPTH] = data;
+    tx_level++;
+    run();
+}
+
+void pio_sm_put_blocking(PIO pio, uint sm, uint32_t data)
+{
+    if (pio_sm_is_tx_fifo_full(pio, sm))
+        panic("mem_pio: TX FIFO full with nothing draining the RX FIFO");
+    pio_sm_put(pio, sm, data);
+}
+
+uint32_t pio_sm_get(PIO pio, uint sm)
+{
+    uint32_t data;
+
+    if (!rx_level)
+        panic("mem_pio: RX FIFO read while empty");
+    data = rx[rx_head];
+    rx_head = (rx_head + 1) % MEM_PIO_FIFO_DEPTH;
+    rx_level--;
+    run(); // A command stalled on the full RX FIFO can go now
+    return data;
+}
+
+uint32_t pio_sm_get_blocking(PIO pio, uint sm)
+{
+    return pio_sm_get(pio, sm);
+}
+
+bool pio_sm_is_rx_fifo_empty(PIO pio, uint sm)
+{
+    return rx_level == 0;
+}
+
+bool pio_sm_is_tx_fifo_full(PIO pio, uint sm)
+{
+    return tx_level >= MEM_PIO_FIFO_DEPTH;
+}
+
+bool pio_sm_is_tx_fifo_empty(PIO pio, uint sm)
+{
+    return tx_level == 0;
+}
+
+uint pio_sm_get_rx_fifo_level(PIO pio, uint sm)
+{
+    return rx_level;
+}
+
+uint pio_sm_get_tx_fifo_level(PIO pio, uint sm)
+{
+    return tx_level;
+}
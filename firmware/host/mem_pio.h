@@ -0,0 +1,23 @@
+#ifndef MEM_PIO_H
+#define MEM_PIO_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "hardware/pio.h"
+
+/**
+ * @brief Replacements for the plain reads and writes of the in-memory cells.
+ */
+typedef struct {
+    uint8_t (*read)(uint8_t *cells, uint32_t addr);
+    void (*write)(uint8_t *cells, uint32_t addr, uint8_t data);
+} mem_pio_cell_ops_t;
+
+// Function prototypes
+bool mem_pio_install(uint8_t index);
+void mem_pio_remove(void);
+uint64_t mem_pio_accesses(void);
+void mem_pio_set_observer(void (*observer)(void));
+void mem_pio_set_cell_ops(const mem_pio_cell_ops_t *ops);
+
+#endif // MEM_PIO_H
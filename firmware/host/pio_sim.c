@@ -0,0 +1,704 @@
+/*
+ * pio_sim.c
+ *
+ * Cycle-accurate model of the RP2350 PIO blocks behind the host
+ * hardware/pio.h. Each call to pio_sim_step runs one system clock cycle:
+ * the attached device sees the pins as the state machines left them, the
+ * input synchronizers shift, then every enabled state machine executes or
+ * counts down its delay. Pin writes made during a cycle appear on the
+ * pins at the start of the next one.
+ *
+ * Everything the DRAM programs use is modelled: JMP, WAIT on pins, IN,
+ * OUT, PUSH, PULL, MOV (including `mov pindirs`), SET, delays, wrapping,
+ * autopush, autopull and the input sync bypass. Side-set, IRQ and EXEC
+ * destinations are not used by any program here and stop the simulation.
+ */
+
+#include <string.h>
+#include "pio_sim.h"
+#include "hardware/clocks.h"
+
+#define PIO_FIFO_DEPTH 4
+
+/**
+ * @brief The state of one simulated state machine.
+ */
+typedef struct {
+    bool claimed;
+    bool enabled;
+    pio_sm_config config;
+    uint8_t pc;
+    uint8_t delay;          // Delay cycles left before the next instruction
+    uint32_t div_count;     // Cycles since the state machine last ran
+    uint32_t x;
+    uint32_t y;
+    uint32_t isr;
+    uint32_t osr;
+    uint8_t isr_count;      // Bits shifted into the ISR
+    uint8_t osr_count;      // Bits shifted out of the OSR, 32 when empty
+    bool exec_pending;      // An instruction from pio_sm_exec runs next
+    uint16_t exec_instr;
+    uint32_t tx[PIO_FIFO_DEPTH];
+    uint8_t tx_head;
+    uint8_t tx_level;
+    uint32_t rx[PIO_FIFO_DEPTH];
+    uint8_t rx_head;
+    uint8_t rx_level;
+} pio_sim_sm_t;
+
+pio_hw_t pio_host_hw[NUM_PIOS];
+
+static pio_sim_sm_t pio_sim_sms[NUM_PIOS][NUM_PIO_STATE_MACHINES];
+static uint32_t pio_sim_used_instr[NUM_PIOS];
+
+// Pin levels driven by the state machines now, and from the next cycle on
+static uint32_t pin_out, pin_oe;
+static uint32_t next_out, next_oe;
+// Pin levels the device saw in the last cycle
+static uint32_t seen_out, seen_oe;
+// Pin levels of the last few cycles, for the input synchronizers
+static uint32_t pin_history[PIO_SIM_SYNC_CYCLES + 1];
+
+static pio_sim_device_t pio_sim_device;
+
+// Cycle count, and the time at the last clock change so cycles map onto picoseconds
+static uint64_t sim_cycle;
+static uint64_t base_cycle;
+static uint64_t base_ps;
+static uint32_t base_hz;
+
+/**
+ * @brief Returns the state machine behind an SDK handle.
+ */
+static pio_sim_sm_t *get_sm(PIO pio, uint sm)
+{
+    uint block = (uint)(pio - pio_host_hw);
+
+    if ((block >= NUM_PIOS) || (sm >= NUM_PIO_STATE_MACHINES))
+        panic("pio_sim: no state machine %u on PIO %u", sm, block);
+    return &pio_sim_sms[block][sm];
+}
+
+/**
+ * @brief Puts every PIO block back to its reset state and detaches any device.
+ */
+void pio_sim_reset(void)
+{
+    memset(pio_host_hw, 0, sizeof(pio_host_hw));
+    memset(pio_sim_sms, 0, sizeof(pio_sim_sms));
+    memset(pio_sim_used_instr, 0, sizeof(pio_sim_used_instr));
+    memset(pin_history, 0, sizeof(pin_history));
+    memset(&pio_sim_device, 0, sizeof(pio_sim_device));
+    pin_out = pin_oe = next_out = next_oe = seen_out = seen_oe = 0;
+    sim_cycle = base_cycle = base_ps = 0;
+    base_hz = 0;
+}
+
+/**
+ * @brief Wires a device to the GPIOs, replacing any attached before.
+ *
+ * @param device The device, copied.
+ */
+void pio_sim_attach(const pio_sim_device_t *device)
+{
+    pio_sim_device = *device;
+}
+
+/**
+ * @brief Returns the number of cycles simulated since the last reset.
+ */
+uint64_t pio_sim_cycles(void)
+{
+    return sim_cycle;
+}
+
+/**
+ * @brief Returns when a cycle started, in picoseconds since the last reset.
+ *
+ * Follows changes to the system clock made with set_sys_clock_khz.
+ *
+ * @param cycle A cycle no earlier than the last clock change.
+ */
+uint64_t pio_sim_time_ps(uint64_t cycle)
+{
+    return base_ps + (cycle - base_cycle) * 1000000000000ULL / base_hz;
+}
+
+/**
+ * @brief Returns the configuration a state machine was initialized with.
+ */
+const pio_sm_config *pio_sim_get_config(PIO pio, uint sm)
+{
+    return &get_sm(pio, sm)->config;
+}
+
+/**
+ * @brief Returns the program counter of a state machine.
+ */
+uint8_t pio_sim_get_pc(PIO pio, uint sm)
+{
+    return get_sm(pio, sm)->pc;
+}
+
+/**
+ * @brief Drives `count` pins from `base` (wrapping at 32) with the low bits of `value`.
+ */
+static void write_pins(uint base, uint count, uint32_t value)
+{
+    uint i;
+    uint32_t bit;
+
+    for (i = 0; i < count; i++) {
+        bit = 1u << ((base + i) & 31);
+        next_out = (value & (1u << i)) ? (next_out | bit) : (next_out & ~bit);
+    }
+}
+
+/**
+ * @brief Sets the direction of `count` pins from `base` from the low bits of `value`.
+ */
+static void write_pindirs(uint base, uint count, uint32_t value)
+{
+    uint i;
+    uint32_t bit;
+
+    for (i = 0; i < count; i++) {
+        bit = 1u << ((base + i) & 31);
+        next_oe = (value & (1u << i)) ? (next_oe | bit) : (next_oe & ~bit);
+    }
+}
+
+/**
+ * @brief Reads the pins from `base` upwards, wrapping at 32, as the state machine sees them.
+ */
+static uint32_t read_pins(uint32_t levels, uint base)
+{
+    base &= 31;
+    return base ? ((levels >> base) | (levels << (32 - base))) : levels;
+}
+
+static bool tx_pop(pio_sim_sm_t *s, uint32_t *data)
+{
+    if (!s->tx_level)
+        return false;
+    *data = s->tx[s->tx_head];
+    s->tx_head = (s->tx_head + 1) % PIO_FIFO_DEPTH;
+    s->tx_level--;
+    return true;
+}
+
+static bool rx_push(pio_sim_sm_t *s, uint32_t data)
+{
+    if (s->rx_level >= PIO_FIFO_DEPTH)
+        return false;
+    s->rx[(s->rx_head + s->rx_level) % PIO_FIFO_DEPTH] = data;
+    s->rx_level++;
+    return true;
+}
+
+static uint32_t bit_reverse(uint32_t v)
+{
+    uint32_t r = 0;
+    uint i;
+
+    for (i = 0; i < 32; i++) {
+        r = (r << 1) | (v & 1);
+        v >>= 1;
+    }
+    return r;
+}
+
+/**
+ * @brief Shifts `count` bits into the ISR.
+ */
+static void shift_in(pio_sim_sm_t *s, uint32_t data, uint count)
+{
+    if (count < 32)
+        data &= (1u << count) - 1;
+    if (count == 32)
+        s->isr = data;
+    else if (s->config.in_shift_right)
+        s->isr = (s->isr >> count) | (data << (32 - count));
+    else
+        s->isr = (s->isr << count) | data;
+    s->isr_count = MIN(s->isr_count + count, 32);
+}
+
+/**
+ * @brief Shifts `count` bits out of the OSR.
+ */
+static uint32_t shift_out(pio_sim_sm_t *s, uint count)
+{
+    uint32_t data;
+
+    if (count == 32) {
+        data = s->osr;
+        s->osr = 0;
+    } else if (s->config.out_shift_right) {
+        data = s->osr & ((1u << count) - 1);
+        s->osr >>= count;
+    } else {
+        data = s->osr >> (32 - count);
+        s->osr <<= count;
+    }
+    s->osr_count = MIN(s->osr_count + count, 32);
+    return data;
+}
+
+/**
+ * @brief Executes one instruction.
+ *
+ * @param pio The PIO block of the state machine.
+ * @param s The state machine.
+ * @param instr The instruction, with jump targets already relocated.
+ * @param levels Pin levels as the state machine sees them this cycle.
+ * @param jumped Set if the instruction wrote the program counter.
+ * @return False if the instruction stalls and must be retried next cycle.
+ */
+static bool execute(PIO pio, pio_sim_sm_t *s, uint16_t instr, uint32_t levels, bool *jumped)
+{
+    uint op = instr >> 13;
+    uint arg1 = (instr >> 5) & 7;
+    uint arg2 = instr & 0x1f;
+    uint count = arg2 ? arg2 : 32;
+    uint32_t data = 0;
+    bool cond;
+
+    *jumped = false;
+    switch (op) {
+    case 0: // JMP
+        switch (arg1) {
+        case 0: cond = true; break;
+        case 1: cond = (s->x == 0); break;
+        case 2: cond = (s->x != 0); s->x--; break;
+        case 3: cond = (s->y == 0); break;
+        case 4: cond = (s->y != 0); s->y--; break;
+        case 5: cond = (s->x != s->y); break;
+        case 7: cond = (s->osr_count < s->config.pull_threshold); break;
+        default: panic("pio_sim: jmp pin is not modelled");
+        }
+        if (cond) {
+            s->pc = arg2;
+            *jumped = true;
+        }
+        return true;
+
+    case 1: // WAIT
+        switch (arg1 & 3) {
+        case 0: cond = (levels >> arg2) & 1; break;
+        case 1: cond = read_pins(levels, s->config.in_base + arg2) & 1; break;
+        default: panic("pio_sim: wait irq is not modelled");
+        }
+        return cond == (arg1 >> 2);
+
+    case 2: // IN
+        if (s->config.autopush && (s->isr_count + count >= s->config.push_threshold) &&
+            (s->rx_level >= PIO_FIFO_DEPTH))
+            return false;
+        switch (arg1) {
+        case 0:
+            data = read_pins(levels, s->config.in_base);
+            if (pio_sim_device.sample) {
+                cond = (pio->input_sync_bypass >> s->config.in_base) & 1;
+                pio_sim_device.sample(pio_sim_device.ctx, sim_cycle - (cond ? 0 : PIO_SIM_SYNC_CYCLES), levels);
+            }
+            break;
+        case 1: data = s->x; break;
+        case 2: data = s->y; break;
+        case 3: data = 0; break;
+        case 6: data = s->isr; break;
+        case 7: data = s->osr; break;
+        default: panic("pio_sim: reserved in source");
+        }
+        shift_in(s, data, count);
+        if (s->config.autopush && (s->isr_count >= s->config.push_threshold)) {
+            rx_push(s, s->isr);
+            s->isr = 0;
+            s->isr_count = 0;
+        }
+        return true;
+
+    case 3: // OUT
+        if (s->config.autopull && (s->osr_count >= s->config.pull_threshold)) {
+            if (!tx_pop(s, &s->osr))
+                return false;
+            s->osr_count = 0;
+        }
+        data = shift_out(s, count);
+        switch (arg1) {
+        case 0: write_pins(s->config.out_base, s->config.out_count, data); break;
+        case 1: s->x = data; break;
+        case 2: s->y = data; break;
+        case 3: break;
+        case 4: write_pindirs(s->config.out_base, s->config.out_count, data); break;
+        case 5: s->pc = data & 0x1f; *jumped = true; break;
+        case 6: s->isr = data; s->isr_count = count; break;
+        default: panic("pio_sim: out exec is not modelled");
+        }
+        return true;
+
+    case 4: // PUSH, PULL
+        if (instr & 0x80) {
+            if ((instr & 0x40) && (s->osr_count < s->config.pull_threshold))
+                return true; // ifempty, and it is not
+            if (!tx_pop(s, &s->osr)) {
+                if (instr & 0x20)
+                    return false; // block
+                s->osr = s->x; // noblock on an empty FIFO copies X
+            }
+            s->osr_count = 0;
+        } else {
+            if ((instr & 0x40) && (s->isr_count < s->config.push_threshold))
+                return true; // iffull, and it is not
+            if ((s->rx_level >= PIO_FIFO_DEPTH) && (instr & 0x20))
+                return false; // block
+            rx_push(s, s->isr); // noblock drops the data when full
+            s->isr = 0;
+            s->isr_count = 0;
+        }
+        return true;
+
+    case 5: // MOV
+        switch (arg2 & 7) {
+        case 0: data = read_pins(levels, s->config.in_base); break;
+        case 1: data = s->x; break;
+        case 2: data = s->y; break;
+        case 3: data = 0; break;
+        case 6: data = s->isr; break;
+        case 7: data = s->osr; break;
+        default: panic("pio_sim: mov status is not modelled");
+        }
+        if (((arg2 >> 3) & 3) == 1)
+            data = ~data;
+        else if (((arg2 >> 3) & 3) == 2)
+            data = bit_reverse(data);
+        switch (arg1) {
+        case 0: write_pins(s->config.out_base, s->config.out_count, data); break;
+        case 1: s->x = data; break;
+        case 2: s->y = data; break;
+        case 3: write_pindirs(s->config.out_base, s->config.out_count, data); break;
+        case 5: s->pc = data & 0x1f; *jumped = true; break;
+        case 6: s->isr = data; s->isr_count = 0; break;
+        case 7: s->osr = data; s->osr_count = 0; break;
+        default: panic("pio_sim: mov exec is not modelled");
+        }
+        return true;
+
+    case 6: // IRQ
+        panic("pio_sim: irq is not modelled");
+
+    default: // SET
+        switch (arg1) {
+        case 0: write_pins(s->config.set_base, s->config.set_count, arg2); break;
+        case 1: s->x = arg2; break;
+        case 2: s->y = arg2; break;
+        case 4: write_pindirs(s->config.set_base, s->config.set_count, arg2); break;
+        default: panic("pio_sim: reserved set destination");
+        }
+        return true;
+    }
+}
+
+/**
+ * @brief Runs one cycle of a state machine.
+ */
+static void sm_step(PIO pio, pio_sim_sm_t *s, uint32_t levels)
+{
+    uint16_t instr;
+    bool jumped;
+
+    if (!s->enabled)
+        return;
+    if (++s->div_count < s->config.clkdiv)
+        return;
+    s->div_count = 0;
+    if (s->delay) {
+        s->delay--;
+        return;
+    }
+
+    instr = s->exec_pending ? s->exec_instr : (uint16_t)pio->instr_mem[s->pc];
+    if (!execute(pio, s, instr, levels, &jumped))
+        return; // Stalled: retry the same instruction next cycle, without its delay
+    if (s->exec_pending) {
+        s->exec_pending = false;
+    } else if (!jumped) {
+        s->pc = (s->pc == s->config.wrap) ? s->config.wrap_target : (s->pc + 1) & 0x1f;
+    }
+    s->delay = (instr >> 8) & 0x1f; // No program here uses side-set, so all five bits are delay
+}
+
+/**
+ * @brief Simulates one system clock cycle.
+ */
+void pio_sim_step(void)
+{
+    uint32_t drive = 0;
+    uint32_t drive_mask = 0;
+    uint32_t levels;
+    uint32_t synced;
+    uint32_t hz = clock_get_hz(clk_sys);
+    uint block;
+    uint i;
+
+    if (hz != base_hz) {
+        if (base_hz)
+            base_ps = pio_sim_time_ps(sim_cycle);
+        base_cycle = sim_cycle;
+        base_hz = hz;
+    }
+
+    seen_out = pin_out;
+    seen_oe = pin_oe;
+    if (pio_sim_device.cycle)
+        pio_sim_device.cycle(pio_sim_device.ctx, sim_cycle, pin_out, pin_oe, &drive, &drive_mask);
+    // Undriven pins read low
+    levels = (pin_out & pin_oe) | (drive & drive_mask & ~pin_oe);
+    for (i = PIO_SIM_SYNC_CYCLES; i > 0; i--) {
+        pin_history[i] = pin_history[i - 1];
+    }
+    pin_history[0] = levels;
+
+    for (block = 0; block < NUM_PIOS; block++) {
+        synced = (levels & pio_host_hw[block].input_sync_bypass) |
+                 (pin_history[PIO_SIM_SYNC_CYCLES] & ~pio_host_hw[block].input_sync_bypass);
+        for (i = 0; i < NUM_PIO_STATE_MACHINES; i++) {
+            sm_step(&pio_host_hw[block], &pio_sim_sms[block][i], synced);
+        }
+    }
+    pin_out = next_out;
+    pin_oe = next_oe;
+    sim_cycle++;
+}
+
+/**
+ * @brief Runs until a state machine is waiting for a command with nothing queued.
+ *
+ * Also runs until the attached device has seen the pins settle, so edges
+ * from the last command are not counted against whatever comes next.
+ *
+ * @param pio The PIO block.
+ * @param sm The state machine.
+ * @param max_cycles The most cycles to run.
+ * @return False if it was still busy after `max_cycles`.
+ */
+bool pio_sim_run_until_idle(PIO pio, uint sm, uint32_t max_cycles)
+{
+    pio_sim_sm_t *s = get_sm(pio, sm);
+    uint16_t instr;
+    uint32_t i;
+
+    for (i = 0; i < max_cycles; i++) {
+        instr = (uint16_t)pio->instr_mem[s->pc];
+        // A blocking pull of an empty FIFO, with its delay done and the device
+        // having seen its last pin writes
+        if (!s->enabled || (!s->delay && ((instr & 0xe0e0) == 0x80a0) && !s->tx_level &&
+                            (next_out == seen_out) && (next_oe == seen_oe)))
+            return true;
+        pio_sim_step();
+    }
+    return false;
+}
+
+bool pio_claim_free_sm_and_add_program_for_gpio_range(const struct pio_program *program, PIO *pio, uint *sm,
+                                                      uint *offset, uint gpio_base, uint gpio_count,
+                                                      bool set_gpio_base)
+{
+    uint32_t mask = (program->length < 32) ? (1u << program->length) - 1 : 0xffffffff;
+    uint16_t instr;
+    uint block;
+    uint free_sm;
+    uint i;
+    int off;
+
+    for (block = 0; block < NUM_PIOS; block++) {
+        for (free_sm = 0; (free_sm < NUM_PIO_STATE_MACHINES) && pio_sim_sms[block][free_sm].claimed; free_sm++) {}
+        if (free_sm == NUM_PIO_STATE_MACHINES)
+            continue;
+        // Highest free offset first, as pio_add_program does
+        for (off = 32 - program->length; off >= 0; off--) {
+            if (!(pio_sim_used_instr[block] & (mask << off)))
+                break;
+        }
+        if (off < 0)
+            continue;
+
+        pio_sim_used_instr[block] |= mask << off;
+        pio_sim_sms[block][free_sm].claimed = true;
+        for (i = 0; i < program->length; i++) {
+            instr = program->instructions[i];
+            // Relocate jumps
+            pio_host_hw[block].instr_mem[off + i] = ((instr & 0xe000) == 0) ? instr + off : instr;
+        }
+        *pio = &pio_host_hw[block];
+        *sm = free_sm;
+        *offset = off;
+        return true;
+    }
+    return false;
+}
+
+void pio_remove_program_and_unclaim_sm(const struct pio_program *program, PIO pio, uint sm, uint offset)
+{
+    uint32_t mask = (program->length < 32) ? (1u << program->length) - 1 : 0xffffffff;
+    pio_sim_sm_t *s = get_sm(pio, sm);
+
+    pio_sim_used_instr[pio - pio_host_hw] &= ~(mask << offset);
+    s->claimed = false;
+    s->enabled = false;
+}
+
+void pio_gpio_init(PIO pio, uint pin)
+{
+}
+
+void pio_sm_init(PIO pio, uint sm, uint initial_pc, const pio_sm_config *config)
+{
+    pio_sim_sm_t *s = get_sm(pio, sm);
+
+    s->enabled = false;
+    s->config = *config;
+    pio_sm_clear_fifos(pio, sm);
+    pio_sm_restart(pio, sm);
+    s->pc = initial_pc;
+}
+
+void pio_sm_set_enabled(PIO pio, uint sm, bool enabled)
+{
+    get_sm(pio, sm)->enabled = enabled;
+}
+
+void pio_sm_set_consecutive_pindirs(PIO pio, uint sm, uint pin_base, uint pin_count, bool is_out)
+{
+    write_pindirs(pin_base, pin_count, is_out ? 0xffffffff : 0);
+    pin_oe = next_oe;
+}
+
+void pio_sm_set_clkdiv(PIO pio, uint sm, float div)
+{
+    get_sm(pio, sm)->config.clkdiv = (div >= 1) ? (uint32_t)div : 1;
+}
+
+void pio_sm_restart(PIO pio, uint sm)
+{
+    pio_sim_sm_t *s = get_sm(pio, sm);
+
+    s->isr = 0;
+    s->isr_count = 0;
+    s->osr = 0;
+    s->osr_count = 32;
+    s->delay = 0;
+    s->div_count = 0;
+    s->exec_pending = false;
+}
+
+void pio_sm_clear_fifos(PIO pio, uint sm)
+{
+    pio_sim_sm_t *s = get_sm(pio, sm);
+
+    s->tx_level = 0;
+    s->rx_level = 0;
+}
+
+void pio_sm_exec(PIO pio, uint sm, uint instr)
+{
+    pio_sim_sm_t *s = get_sm(pio, sm);
+    bool jumped;
+
+    // A stopped state machine runs it at once; a running one on its next cycle
+    if (!s->enabled) {
+        execute(pio, s, instr, 0, &jumped);
+    } else {
+        s->exec_pending = true;
+        s->exec_instr = instr;
+    }
+}
+
+void pio_sm_put(PIO pio, uint sm, uint32_t data)
+{
+    pio_sim_sm_t *s = get_sm(pio, sm);
+
+    // The real FIFO drops a word written while full; nothing here relies on that
+    if (s->tx_level >= PIO_FIFO_DEPTH)
+        panic("pio_sim: TX FIFO of state machine %u overflowed", sm);
+    s->tx[(s->tx_head + s->tx_level) % PIO_FIFO_DEPTH] = data;
+    s->tx_level++;
+}
+
+void pio_sm_put_blocking(PIO pio, uint sm, uint32_t data)
+{
+    uint32_t polls = 0;
+
+    while (pio_sm_is_tx_fifo_full(pio, sm)) {
+        if (++polls > PIO_SIM_POLL_LIMIT)
+            panic("pio_sim: state machine %u never took a command", sm);
+    }
+    pio_sm_put(pio, sm, data);
+}
+
+uint32_t pio_sm_get(PIO pio, uint sm)
+{
+    pio_sim_sm_t *s = get_sm(pio, sm);
+    uint32_t data;
+
+    if (!s->rx_level)
+        panic("pio_sim: RX FIFO of state machine %u read while empty", sm);
+    data = s->rx[s->rx_head];
+    s->rx_head = (s->rx_head + 1) % PIO_FIFO_DEPTH;
+    s->rx_level--;
+    return data;
+}
+
+uint32_t pio_sm_get_blocking(PIO pio, uint sm)
+{
+    uint32_t polls = 0;
+
+    while (pio_sm_is_rx_fifo_empty(pio, sm)) {
+        if (++polls > PIO_SIM_POLL_LIMIT)
+            panic("pio_sim: state machine %u never answered", sm);
+    }
+    return pio_sm_get(pio, sm);
+}
+
+bool pio_sm_is_rx_fifo_empty(PIO pio, uint sm)
+{
+    static uint32_t polls;
+    pio_sim_sm_t *s = get_sm(pio, sm);
+
+    if (!s->rx_level) {
+        pio_sim_step();
+        if (++polls > PIO_SIM_POLL_LIMIT)
+            panic("pio_sim: state machine %u never answered", sm);
+    }
+    if (s->rx_level)
+        polls = 0;
+    return s->rx_level == 0;
+}
+
+bool pio_sm_is_tx_fifo_full(PIO pio, uint sm)
+{
+    pio_sim_sm_t *s = get_sm(pio, sm);
+
+    if (s->tx_level >= PIO_FIFO_DEPTH)
+        pio_sim_step();
+    return s->tx_level >= PIO_FIFO_DEPTH;
+}
+
+bool pio_sm_is_tx_fifo_empty(PIO pio, uint sm)
+{
+    pio_sim_sm_t *s = get_sm(pio, sm);
+
+    if (s->tx_level)
+        pio_sim_step();
+    return s->tx_level == 0;
+}
+
+uint pio_sm_get_rx_fifo_level(PIO pio, uint sm)
+{
+    return get_sm(pio, sm)->rx_level;
+}
+
+uint pio_sm_get_tx_fifo_level(PIO pio, uint sm)
+{
+    return get_sm(pio, sm)->tx_level;
+}
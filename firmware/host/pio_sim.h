@@ -0,0 +1,39 @@
+#ifndef PIO_SIM_H
+#define PIO_SIM_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "hardware/pio.h"
+
+// Cycles the input synchronizer delays a pin unless it is bypassed
+#define PIO_SIM_SYNC_CYCLES 2
+
+// Cycles a FIFO may be polled without the state machine answering before
+// the simulation gives up on it
+#define PIO_SIM_POLL_LIMIT 1000000
+
+/**
+ * @brief Something wired to the GPIOs, stepped along with the state machines.
+ */
+typedef struct {
+    void *ctx;
+    // Called at the start of every cycle with the level each PIO output pin
+    // holds (`out`, valid where `oe` is set). Returns in `drive` the levels
+    // the device puts on the pins set in `drive_mask`.
+    void (*cycle)(void *ctx, uint64_t cycle, uint32_t out, uint32_t oe, uint32_t *drive, uint32_t *drive_mask);
+    // Called when a state machine reads its IN pins, with the cycle whose
+    // pin levels it saw after the input synchronizer
+    void (*sample)(void *ctx, uint64_t pin_cycle, uint32_t levels);
+} pio_sim_device_t;
+
+// Function prototypes
+void pio_sim_reset(void);
+void pio_sim_attach(const pio_sim_device_t *device);
+void pio_sim_step(void);
+uint64_t pio_sim_cycles(void);
+uint64_t pio_sim_time_ps(uint64_t cycle);
+bool pio_sim_run_until_idle(PIO pio, uint sm, uint32_t max_cycles);
+const pio_sm_config *pio_sim_get_config(PIO pio, uint sm);
+uint8_t pio_sim_get_pc(PIO pio, uint sm);
+
+#endif // PIO_SIM_H
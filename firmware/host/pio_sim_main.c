@@ -0,0 +1,444 @@
+/*
+ * pio_sim_main.c
+ *
+ * Runs every chip's PIO program, at every speed grade, against a DRAM
+ * modelled at its pins, and checks the timing the program produces
+ * against the datasheet timing of the grade. Each chip is driven through
+ * its own setup_pio and block and page routines, so the pin mapping,
+ * delay tables and command encoding are exactly the firmware's.
+ *
+ * Usage: pio_sim [-l] [-c chip] [-g grade] [-v out.vcd]
+ *
+ *   -l   List the chips and speed grades
+ *   -c   Only run one chip (index from -l) and print its full timing table
+ *   -g   Only run one speed grade of that chip
+ *   -v   Write the waveforms of the chip and grade chosen to a VCD file
+ *
+ * Exits with status 1 if any interval is shorter than the datasheet
+ * allows, a read was sampled outside its valid window, the chip and the
+ * PIO drove a pin at the same time, or data read back wrong.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "app_state.h"
+#include "pio_patcher.h"
+#include "pio_sim.h"
+#include "dram_pins.h"
+#include "vcd.h"
+
+// Words moved in each phase. The page phases cover two bursts of
+// RAM_PAGE_BURST so the RAS# precharge between them is measured too.
+#define SIM_BLOCK_WORDS 8
+#define SIM_PAGE_WORDS 20
+
+// Most cycles a state machine may take to finish its queued commands
+#define SIM_IDLE_CYCLES 100000
+
+/**
+ * @brief Where each DRAM pin sits in the pins a program drives.
+ *
+ * ras, cas and we index the SET pins, oe, addr_out and din_out the OUT
+ * pins; -1 where there is no such pin. Q is always the first IN pin. Each
+ * program's pin layout is told apart by its OUT and SET pin counts.
+ */
+typedef struct {
+    uint8_t out_count;
+    uint8_t set_count;
+    int8_t ras[DRAM_PINS_BANKS];
+    int8_t cas[DRAM_PINS_BANKS];
+    int8_t we;
+    int8_t oe;
+    uint8_t addr_out;
+    uint8_t addr_bits;  // Including any unconnected bits the program drives
+    uint8_t din_out;
+    uint8_t data_bits;
+} sim_pin_roles_t;
+
+static const sim_pin_roles_t sim_pin_roles[] = {
+    // 4116, 4164, 41256: A0-A8, D; WE#, RAS#, CAS#
+    { 10, 3, {1, -1}, {2, -1}, 0, -1, 0, 9, 9, 1 },
+    // 4132 stacked: A0-A6, nc, nc, D; WE#, RAS1#, CAS1#, RAS2#, CAS2#
+    { 10, 5, {1, 3}, {2, 4}, 0, -1, 0, 9, 9, 1 },
+    // 41128: A0-A7, D; WE#, RAS1#, RAS2#, CAS# (shared)
+    { 9, 4, {1, 2}, {3, 3}, 0, -1, 0, 8, 8, 1 },
+    // 44256, 4464, 4416: DQ0-DQ3, OE#, A0-A8; RAS#, CAS#, WE#
+    { 14, 3, {0, -1}, {1, -1}, 2, 4, 5, 9, 0, 4 },
+};
+
+static const char *param_names[DRAM_PINS_PARAMS] = {"tRAC", "tCAC", "tRC", "tRAS", "tRP",
+                                                    "tRCD", "tCAS", "tCP", "tWP"};
+static const char *phase_names[DRAM_PHASES] = {"read", "write", "page read", "page write"};
+
+// The chip being simulated, and its waveform dump if one was asked for
+typedef struct {
+    dram_pins_t dram;
+    vcd_t vcd;
+    bool dumping;
+    int id_ras[DRAM_PINS_BANKS];
+    int id_cas[DRAM_PINS_BANKS];
+    int id_we;
+    int id_oe;
+    int id_addr;
+    int id_d;
+    int id_q;
+    int id_pc;
+} sim_target_t;
+
+static sim_target_t target;
+
+/**
+ * @brief Builds the GPIO map of a chip from the configuration its program_init set up.
+ *
+ * @param map Receives the map.
+ * @return False if the program's pin layout is not in sim_pin_roles.
+ */
+static bool build_map(dram_pins_map_t *map)
+{
+    const pio_sm_config *c = pio_sim_get_config(pio, sm);
+    const sim_pin_roles_t *r = NULL;
+    uint8_t i;
+
+    for (i = 0; i < count_of(sim_pin_roles); i++) {
+        if ((sim_pin_roles[i].out_count == c->out_count) && (sim_pin_roles[i].set_count == c->set_count))
+            r = &sim_pin_roles[i];
+    }
+    if (!r)
+        return false;
+
+    for (i = 0; i < DRAM_PINS_BANKS; i++) {
+        map->ras[i] = (r->ras[i] < 0) ? -1 : c->set_base + r->ras[i];
+        map->cas[i] = (r->cas[i] < 0) ? -1 : c->set_base + r->cas[i];
+    }
+    map->we = c->set_base + r->we;
+    map->oe = (r->oe < 0) ? -1 : c->out_base + r->oe;
+    map->addr_base = c->out_base + r->addr_out;
+    map->addr_bits = r->addr_bits;
+    map->din_base = c->out_base + r->din_out;
+    map->dout_base = c->in_base;
+    map->data_bits = r->data_bits;
+    return true;
+}
+
+/**
+ * @brief Returns `width` bits of the pins from `base`.
+ */
+static uint32_t field(uint32_t v, uint8_t base, uint8_t width)
+{
+    return (v >> base) & ((1u << width) - 1);
+}
+
+/**
+ * @brief Steps the chip and records the pins in the dump. Matches pio_sim_device_t.cycle.
+ */
+static void target_cycle(void *ctx, uint64_t cycle, uint32_t out, uint32_t oe, uint32_t *drive, uint32_t *drive_mask)
+{
+    sim_target_t *t = ctx;
+    const dram_pins_map_t *m = &t->dram.map;
+    uint64_t now;
+    uint32_t undriven = ~oe;
+    uint8_t b;
+
+    dram_pins_cycle(&t->dram, cycle, out, oe, drive, drive_mask);
+    if (!t->dumping)
+        return;
+
+    now = pio_sim_time_ps(cycle);
+    for (b = 0; b < DRAM_PINS_BANKS; b++) {
+        if (m->ras[b] < 0)
+            continue;
+        vcd_set(&t->vcd, now, t->id_ras[b], field(out, m->ras[b], 1), 0, field(undriven, m->ras[b], 1));
+        vcd_set(&t->vcd, now, t->id_cas[b], field(out, m->cas[b], 1), 0, field(undriven, m->cas[b], 1));
+    }
+    vcd_set(&t->vcd, now, t->id_we, field(out, m->we, 1), 0, field(undriven, m->we, 1));
+    if (m->oe >= 0)
+        vcd_set(&t->vcd, now, t->id_oe, field(out, m->oe, 1), 0, field(undriven, m->oe, 1));
+    vcd_set(&t->vcd, now, t->id_addr, field(out, m->addr_base, m->addr_bits), 0,
+            field(undriven, m->addr_base, m->addr_bits));
+    vcd_set(&t->vcd, now, t->id_d, field(out, m->din_base, m->data_bits), 0,
+            field(undriven, m->din_base, m->data_bits));
+    vcd_set(&t->vcd, now, t->id_q, field(*drive, m->dout_base, m->data_bits),
+            field(t->dram.x_mask, m->dout_base, m->data_bits),
+            field(~*drive_mask, m->dout_base, m->data_bits));
+    vcd_set(&t->vcd, now, t->id_pc, pio_sim_get_pc(pio, sm), 0, 0);
+}
+
+/**
+ * @brief Opens the dump and declares the chip's pins in it.
+ */
+static bool open_dump(sim_target_t *t, const char *path)
+{
+    const dram_pins_map_t *m = &t->dram.map;
+    bool banked = (m->ras[1] >= 0);
+
+    if (!vcd_open(&t->vcd, path, "dram"))
+        return false;
+    t->id_ras[0] = vcd_add(&t->vcd, banked ? "RAS1_n" : "RAS_n", 1);
+    t->id_cas[0] = vcd_add(&t->vcd, banked ? "CAS1_n" : "CAS_n", 1);
+    if (banked) {
+        t->id_ras[1] = vcd_add(&t->vcd, "RAS2_n", 1);
+        t->id_cas[1] = vcd_add(&t->vcd, "CAS2_n", 1);
+    }
+    t->id_we = vcd_add(&t->vcd, "WE_n", 1);
+    t->id_oe = (m->oe >= 0) ? vcd_add(&t->vcd, "OE_n", 1) : -1;
+    t->id_addr = vcd_add(&t->vcd, "A", m->addr_bits);
+    t->id_d = vcd_add(&t->vcd, "D", m->data_bits);
+    t->id_q = vcd_add(&t->vcd, "Q", m->data_bits);
+    t->id_pc = vcd_add(&t->vcd, "pc", 5);
+    vcd_begin(&t->vcd);
+    t->dumping = true;
+    return true;
+}
+
+/**
+ * @brief Runs the state machine until it has finished the commands queued.
+ */
+static void wait_idle(void)
+{
+    if (!pio_sim_run_until_idle(pio, sm, SIM_IDLE_CYCLES))
+        panic("State machine still busy after %u cycles", SIM_IDLE_CYCLES);
+}
+
+/**
+ * @brief Compares the data read back with what was written.
+ *
+ * @return The number of words that differ.
+ */
+static uint32_t compare(const uint32_t *expect, const uint32_t *got, uint32_t count, uint32_t mask)
+{
+    uint32_t bad = 0;
+    uint32_t i;
+
+    for (i = 0; i < count; i++) {
+        if ((got[i] & mask) != (expect[i] & mask))
+            bad++;
+    }
+    return bad;
+}
+
+/**
+ * @brief Writes and reads back a block, then a page walk, recording each phase.
+ *
+ * @param chip The chip, already set up.
+ * @return The number of words read back wrong.
+ */
+static uint32_t run_phases(const mem_chip_t *chip)
+{
+    uint32_t out[SIM_PAGE_WORDS];
+    uint32_t in[SIM_PAGE_WORDS];
+    uint32_t mask = (1u << chip->bits) - 1;
+    uint32_t bad;
+    uint32_t i;
+    int addr;
+
+    for (i = 0; i < SIM_PAGE_WORDS; i++) {
+        out[i] = (i * 0x9e3779b9u) >> 27;
+    }
+
+    // A run of consecutive addresses away from 0, so row and column bits both toggle
+    addr = 0x2d5 % chip->mem_size;
+    wait_idle();
+    dram_pins_set_phase(&target.dram, DRAM_PHASE_WRITE);
+    chip->ram_write_block(addr, out, SIM_BLOCK_WORDS);
+    wait_idle();
+    dram_pins_set_phase(&target.dram, DRAM_PHASE_READ);
+    chip->ram_read_block(addr, in, SIM_BLOCK_WORDS);
+    wait_idle();
+    bad = compare(out, in, SIM_BLOCK_WORDS, mask);
+
+    if (!chip->page_mode)
+        return bad;
+
+    addr = 0x15 & ((1 << chip->row_bits) - 1); // Column 0 of a row
+    dram_pins_set_phase(&target.dram, DRAM_PHASE_PAGE_WRITE);
+    chip->ram_write_page(addr, out, SIM_PAGE_WORDS);
+    wait_idle();
+    dram_pins_set_phase(&target.dram, DRAM_PHASE_PAGE_READ);
+    chip->ram_read_page(addr, in, SIM_PAGE_WORDS);
+    wait_idle();
+    return bad + compare(out, in, SIM_PAGE_WORDS, mask);
+}
+
+/**
+ * @brief Returns the datasheet value of a parameter in nanoseconds.
+ */
+static uint16_t spec_ns(const ram_timing_t *t, uint8_t param)
+{
+    const uint16_t v[DRAM_PINS_PARAMS] = {t->trac, t->tcac, t->trc, t->tras, t->trp,
+                                          t->trcd, t->tcas, t->tcp, t->twp};
+    return v[param];
+}
+
+/**
+ * @brief Prints the measured timing of a chip against its datasheet, one row per parameter.
+ */
+static void print_table(const mem_chip_t *chip, uint8_t grade)
+{
+    const ram_timing_t *spec = &chip->timings[grade];
+    uint32_t ps;
+    uint8_t param;
+    uint8_t phase;
+
+    printf("%s %s\n  %-5s %6s", chip->chip_name, chip->speed_names[grade], "", "spec");
+    for (phase = 0; phase < DRAM_PHASES; phase++) {
+        printf(" %11s", phase_names[phase]);
+    }
+    printf("\n");
+    for (param = 0; param < DRAM_PINS_PARAMS; param++) {
+        printf("  %-5s %6u", param_names[param], spec_ns(spec, param));
+        for (phase = 0; phase < DRAM_PHASES; phase++) {
+            ps = target.dram.stats[phase].min_ps[param];
+            if (ps == UINT32_MAX)
+                printf(" %11s", "-");
+            else
+                printf(" %10.1f%c", ps / 1000.0, (ps < spec_ns(spec, param) * 1000u) ? '!' : ' ');
+        }
+        printf("\n");
+    }
+}
+
+/**
+ * @brief Simulates one chip at one speed grade and reports any problem.
+ *
+ * @param index The chip's index in chip_list.
+ * @param grade The speed grade.
+ * @param table Print the full timing table.
+ * @param vcd_path Dump the waveforms here, or NULL.
+ * @return True if the chip passed.
+ */
+static bool simulate(uint8_t index, uint8_t grade, bool table, const char *vcd_path)
+{
+    const mem_chip_t *chip = chip_list[index];
+    const ram_timing_t *spec = &chip->timings[grade];
+    const pio_sim_device_t device = { .ctx = &target, .cycle = target_cycle, .sample = dram_pins_sample };
+    dram_pins_map_t map;
+    uint32_t bad;
+    uint32_t ps;
+    uint8_t param;
+    uint8_t phase;
+    bool ok = true;
+
+    main_menu.sel_line = index;
+    pio_sim_attach(&(pio_sim_device_t){0});
+    chip->setup_pio(grade, 0);
+    if (!build_map(&map))
+        panic("%s: no pin roles for its program", chip->chip_name);
+    if (!dram_pins_init(&target.dram, &map, spec))
+        panic("Out of memory for the cells");
+    target.dumping = false;
+    if (vcd_path && !open_dump(&target, vcd_path))
+        panic("Cannot create %s", vcd_path);
+    pio_sim_attach(&device);
+
+    bad = run_phases(chip);
+    chip->teardown_pio();
+
+    if (table)
+        print_table(chip, grade);
+    for (phase = 0; phase < DRAM_PHASES; phase++) {
+        for (param = 0; param < DRAM_PINS_PARAMS; param++) {
+            ps = target.dram.stats[phase].min_ps[param];
+            if ((ps == UINT32_MAX) || (ps >= spec_ns(spec, param) * 1000u))
+                continue;
+            printf("%s %s: %s %.1fns in %s, datasheet %uns\n", chip->chip_name, chip->speed_names[grade],
+                   param_names[param], ps / 1000.0, phase_names[phase], spec_ns(spec, param));
+            ok = false;
+        }
+    }
+    if (target.dram.bad_samples) {
+        printf("%s %s: %u reads sampled outside the valid window\n", chip->chip_name,
+               chip->speed_names[grade], target.dram.bad_samples);
+        ok = false;
+    }
+    if (target.dram.contention) {
+        printf("%s %s: chip and PIO both drove the data pins for %u cycles\n", chip->chip_name,
+               chip->speed_names[grade], target.dram.contention);
+        ok = false;
+    }
+    if (bad) {
+        printf("%s %s: %u words read back wrong\n", chip->chip_name, chip->speed_names[grade], bad);
+        ok = false;
+    }
+    if (ok && !table)
+        printf("%s %s: ok\n", chip->chip_name, chip->speed_names[grade]);
+
+    if (target.dumping)
+        vcd_close(&target.vcd);
+    dram_pins_free(&target.dram);
+    return ok;
+}
+
+/**
+ * @brief Patches every grade of every program into the cache, as the firmware does at boot.
+ */
+static void cache_programs(void)
+{
+    uint8_t i;
+
+    for (i = 0; i < NUM_CHIPS; i++) {
+        pio_cache_add(chip_list[i]->program, chip_list[i]->delays, chip_list[i]->speed_grades,
+                      chip_list[i]->delay_fields);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    const char *vcd_path = NULL;
+    int chip = -1;
+    int grade = -1;
+    bool list = false;
+    bool ok = true;
+    uint8_t i, g;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "lc:g:v:")) != -1) {
+        switch (opt) {
+        case 'l':
+            list = true;
+            break;
+        case 'c':
+            chip = atoi(optarg);
+            break;
+        case 'g':
+            grade = atoi(optarg);
+            break;
+        case 'v':
+            vcd_path = optarg;
+            break;
+        default:
+            fprintf(stderr, "Usage: %s [-l] [-c chip] [-g grade] [-v out.vcd]\n", argv[0]);
+            return 2;
+        }
+    }
+    if ((chip >= NUM_CHIPS) || ((chip >= 0) && (grade >= chip_list[chip]->speed_grades)) ||
+        ((grade >= 0) && (chip < 0)) || (vcd_path && (grade < 0))) {
+        fprintf(stderr, "-g needs -c, -v needs -c and -g, and both must be listed by -l\n");
+        return 2;
+    }
+
+    if (list) {
+        for (i = 0; i < NUM_CHIPS; i++) {
+            printf("%2u %s:", i, chip_list[i]->chip_name);
+            for (g = 0; g < chip_list[i]->speed_grades; g++) {
+                printf(" %u=%s", g, chip_list[i]->speed_names[g]);
+            }
+            printf("\n");
+        }
+        return 0;
+    }
+
+    cache_programs();
+    pio_sim_reset();
+    for (i = 0; i < NUM_CHIPS; i++) {
+        if ((chip >= 0) && (i != chip))
+            continue;
+        for (g = 0; g < chip_list[i]->speed_grades; g++) {
+            if ((grade >= 0) && (g != grade))
+                continue;
+            ok &= simulate(i, g, chip >= 0, vcd_path);
+        }
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,23 @@
+#ifndef HOST_HARDWARE_ADDRESS_MAPPED_H
+#define HOST_HARDWARE_ADDRESS_MAPPED_H
+
+#include "pico.h"
+
+// Registers are plain memory on the host, so the atomic aliases become read-modify-write
+
+static inline void hw_set_bits(volatile uint32_t *addr, uint32_t mask)
+{
+    *addr |= mask;
+}
+
+static inline void hw_clear_bits(volatile uint32_t *addr, uint32_t mask)
+{
+    *addr &= ~mask;
+}
+
+static inline void hw_write_masked(volatile uint32_t *addr, uint32_t values, uint32_t write_mask)
+{
+    *addr = (*addr & ~write_mask) | (values & write_mask);
+}
+
+#endif // HOST_HARDWARE_ADDRESS_MAPPED_H
@@ -0,0 +1,17 @@
+#ifndef HOST_HARDWARE_CLOCKS_H
+#define HOST_HARDWARE_CLOCKS_H
+
+#include "pico.h"
+
+enum clock_index {
+    clk_ref = 4,
+    clk_sys = 5
+};
+
+// The system clock is a setting on the host. It starts at the firmware's
+// 300 MHz and sets the length of a simulated PIO cycle.
+uint32_t clock_get_hz(enum clock_index clk_index);
+bool check_sys_clock_khz(uint32_t freq_khz, uint *vco_freq_out, uint *post_div1_out, uint *post_div2_out);
+bool set_sys_clock_khz(uint32_t freq_khz, bool required);
+
+#endif // HOST_HARDWARE_CLOCKS_H
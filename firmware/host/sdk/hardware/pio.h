@@ -0,0 +1,161 @@
+/*
+ * hardware/pio.h
+ *
+ * Host stand-in for the SDK's PIO API. The state machines behind it are
+ * simulated cycle by cycle in pio_sim.c, so the firmware's own program
+ * loading, *_program_init and FIFO routines run unchanged. mem_pio.c
+ * implements the same API over a DRAM held in memory instead.
+ */
+
+#ifndef HOST_HARDWARE_PIO_H
+#define HOST_HARDWARE_PIO_H
+
+#include "pico.h"
+#include "hardware/address_mapped.h"
+#include "hardware/gpio.h"
+
+#define NUM_PIOS 3
+#define NUM_PIO_STATE_MACHINES 4
+#define PIO_INSTRUCTION_COUNT 32
+
+/**
+ * @brief The registers of one PIO block that the firmware touches directly.
+ */
+typedef struct {
+    volatile uint32_t txf[NUM_PIO_STATE_MACHINES];
+    volatile uint32_t rxf[NUM_PIO_STATE_MACHINES];
+    volatile uint32_t input_sync_bypass;
+    volatile uint32_t instr_mem[PIO_INSTRUCTION_COUNT];
+} pio_hw_t;
+
+typedef pio_hw_t *PIO;
+
+extern pio_hw_t pio_host_hw[NUM_PIOS];
+
+#define pio0 (&pio_host_hw[0])
+#define pio1 (&pio_host_hw[1])
+#define pio2 (&pio_host_hw[2])
+
+struct pio_program {
+    const uint16_t *instructions;
+    uint8_t length;
+    int8_t origin;
+    uint8_t pio_version;
+    uint32_t used_gpio_ranges;
+};
+
+/**
+ * @brief State machine configuration, kept as fields rather than packed registers.
+ */
+typedef struct {
+    uint32_t clkdiv;       // Integer clock divider
+    uint8_t wrap_target;   // Where the program wraps to
+    uint8_t wrap;          // Last instruction before wrapping
+    uint8_t out_base;
+    uint8_t out_count;
+    uint8_t set_base;
+    uint8_t set_count;
+    uint8_t in_base;
+    bool out_shift_right;
+    bool autopull;
+    uint8_t pull_threshold; // 1-32
+    bool in_shift_right;
+    bool autopush;
+    uint8_t push_threshold; // 1-32
+} pio_sm_config;
+
+static inline pio_sm_config pio_get_default_sm_config(void)
+{
+    pio_sm_config c = {
+        .clkdiv = 1,
+        .wrap_target = 0,
+        .wrap = PIO_INSTRUCTION_COUNT - 1,
+        .out_shift_right = true,
+        .pull_threshold = 32,
+        .in_shift_right = true,
+        .push_threshold = 32,
+    };
+    return c;
+}
+
+static inline void sm_config_set_wrap(pio_sm_config *c, uint wrap_target, uint wrap)
+{
+    c->wrap_target = wrap_target;
+    c->wrap = wrap;
+}
+
+static inline void sm_config_set_out_pins(pio_sm_config *c, uint out_base, uint out_count)
+{
+    c->out_base = out_base;
+    c->out_count = out_count;
+}
+
+static inline void sm_config_set_set_pins(pio_sm_config *c, uint set_base, uint set_count)
+{
+    c->set_base = set_base;
+    c->set_count = set_count;
+}
+
+static inline void sm_config_set_in_pins(pio_sm_config *c, uint in_base)
+{
+    c->in_base = in_base;
+}
+
+static inline void sm_config_set_out_shift(pio_sm_config *c, bool shift_right, bool autopull, uint pull_threshold)
+{
+    c->out_shift_right = shift_right;
+    c->autopull = autopull;
+    c->pull_threshold = pull_threshold ? pull_threshold : 32;
+}
+
+static inline void sm_config_set_in_shift(pio_sm_config *c, bool shift_right, bool autopush, uint push_threshold)
+{
+    c->in_shift_right = shift_right;
+    c->autopush = autopush;
+    c->push_threshold = push_threshold ? push_threshold : 32;
+}
+
+static inline void sm_config_set_clkdiv_int_frac(pio_sm_config *c, uint16_t div_int, uint8_t div_frac)
+{
+    c->clkdiv = div_int ? div_int : 1;
+}
+
+static inline uint pio_encode_jmp(uint addr)
+{
+    return addr & 0x1f;
+}
+
+static inline uint pio_get_dreq(PIO pio, uint sm, bool is_tx)
+{
+    return (uint)(pio - pio_host_hw) * 8 + (is_tx ? 0 : 4) + sm;
+}
+
+// Program memory and state machine ownership
+bool pio_claim_free_sm_and_add_program_for_gpio_range(const struct pio_program *program, PIO *pio, uint *sm,
+                                                      uint *offset, uint gpio_base, uint gpio_count,
+                                                      bool set_gpio_base);
+void pio_remove_program_and_unclaim_sm(const struct pio_program *program, PIO pio, uint sm, uint offset);
+
+// State machine control
+void pio_gpio_init(PIO pio, uint pin);
+void pio_sm_init(PIO pio, uint sm, uint initial_pc, const pio_sm_config *config);
+void pio_sm_set_enabled(PIO pio, uint sm, bool enabled);
+void pio_sm_set_consecutive_pindirs(PIO pio, uint sm, uint pin_base, uint pin_count, bool is_out);
+void pio_sm_set_clkdiv(PIO pio, uint sm, float div);
+void pio_sm_restart(PIO pio, uint sm);
+void pio_sm_clear_fifos(PIO pio, uint sm);
+void pio_sm_exec(PIO pio, uint sm, uint instr);
+
+// FIFOs. Polling a FIFO lets the simulated state machines run, the way
+// they keep running while the CPU spins on the real thing.
+void pio_sm_put(PIO pio, uint sm, uint32_t data);
+void pio_sm_put_blocking(PIO pio, uint sm, uint32_t data);
+uint32_t pio_sm_get(PIO pio, uint sm);
+uint32_t pio_sm_get_blocking(PIO pio, uint sm);
+bool pio_sm_is_rx_fifo_empty(PIO pio, uint sm);
+bool pio_sm_is_tx_fifo_full(PIO pio, uint sm);
+bool pio_sm_is_tx_fifo_empty(PIO pio, uint sm);
+uint pio_sm_get_rx_fifo_level(PIO pio, uint sm);
+uint pio_sm_get_tx_fifo_level(PIO pio, uint sm);
+
+#endif // HOST_HARDWARE_PIO_H
@@ -0,0 +1,14 @@
+#ifndef HOST_HARDWARE_SYNC_H
+#define HOST_HARDWARE_SYNC_H
+
+#include "pico.h"
+
+static inline void __dmb(void)
+{
+    __sync_synchronize();
+}
+
+static inline void __sev(void) {}
+static inline void __wfe(void) {}
+
+#endif // HOST_HARDWARE_SYNC_H
@@ -0,0 +1,13 @@
+#ifndef HOST_HARDWARE_VREG_H
+#define HOST_HARDWARE_VREG_H
+
+#include "pico.h"
+
+enum vreg_voltage {
+    VREG_VOLTAGE_1_10 = 11,
+    VREG_VOLTAGE_1_20 = 13
+};
+
+void vreg_set_voltage(enum vreg_voltage voltage);
+
+#endif // HOST_HARDWARE_VREG_H
@@ -0,0 +1,38 @@
+/*
+ * pico.h
+ *
+ * Host stand-in for the base definitions of the Pico SDK, so that the
+ * firmware modules that do not touch the display can be built on Linux.
+ * Only what the firmware uses is provided.
+ */
+
+#ifndef HOST_PICO_H
+#define HOST_PICO_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+typedef unsigned int uint;
+
+// RP2350 PIO blocks support `mov pindirs` and the other version 1 additions
+#define PICO_PIO_VERSION 1
+
+#define __force_inline inline __attribute__((always_inline))
+#define __not_in_flash_func(f) f
+#define __time_critical_func(f) f
+
+#define count_of(a) (sizeof(a) / sizeof((a)[0]))
+
+#ifndef MIN
+#define MIN(a, b) ((b) < (a) ? (b) : (a))
+#endif
+#ifndef MAX
+#define MAX(a, b) ((a) < (b) ? (b) : (a))
+#endif
+
+void panic(const char *fmt, ...) __attribute__((noreturn));
+
+static inline void tight_loop_contents(void) {}
+
+#endif // HOST_PICO_H
@@ -0,0 +1,15 @@
+#ifndef HOST_PICO_MULTICORE_H
+#define HOST_PICO_MULTICORE_H
+
+#include "pico.h"
+
+// The host runs everything on one thread, so there is no second core to start
+void multicore_reset_core1(void);
+void multicore_launch_core1(void (*entry)(void));
+
+static inline uint get_core_num(void)
+{
+    return 0;
+}
+
+#endif // HOST_PICO_MULTICORE_H
@@ -0,0 +1,31 @@
+#ifndef HOST_PICO_UTIL_QUEUE_H
+#define HOST_PICO_UTIL_QUEUE_H
+
+#include "pico.h"
+
+/**
+ * @brief Fixed-size FIFO of fixed-size elements, as in the SDK.
+ *
+ * Only one thread uses it on the host, so adding to a full queue drops the
+ * oldest element instead of blocking forever.
+ */
+typedef struct {
+    uint8_t *data;
+    uint element_size;
+    uint element_count;
+    uint rptr;
+    uint count;
+} queue_t;
+
+void queue_init(queue_t *q, uint element_size, uint element_count);
+bool queue_try_add(queue_t *q, const void *data);
+bool queue_try_remove(queue_t *q, void *data);
+void queue_add_blocking(queue_t *q, const void *data);
+void queue_remove_blocking(queue_t *q, void *data);
+
+static inline bool queue_is_empty(queue_t *q)
+{
+    return q->count == 0;
+}
+
+#endif // HOST_PICO_UTIL_QUEUE_H
@@ -0,0 +1,126 @@
+/*
+ * vcd.c
+ *
+ * Minimal Value Change Dump writer for the PIO simulator's waveforms,
+ * readable by GTKWave and most logic analyzer software. Time is in
+ * picoseconds. Only changes are written, so long idle stretches cost
+ * nothing.
+ */
+
+#include <string.h>
+#include "vcd.h"
+
+/**
+ * @brief Creates a dump and writes its header.
+ *
+ * @param v The dump.
+ * @param path The file to write.
+ * @param module The scope the signals appear under.
+ * @return False if the file could not be created.
+ */
+bool vcd_open(vcd_t *v, const char *path, const char *module)
+{
+    memset(v, 0, sizeof(*v));
+    v->f = fopen(path, "w");
+    if (!v->f)
+        return false;
+    fprintf(v->f, "$timescale 1ps $end\n$scope module %s $end\n", module);
+    return true;
+}
+
+/**
+ * @brief Declares a signal. Call before vcd_begin.
+ *
+ * @param v The dump.
+ * @param name The signal name.
+ * @param width Its width in bits, 1-32.
+ * @return Its id for vcd_set, or -1 if there is no room for it.
+ */
+int vcd_add(vcd_t *v, const char *name, uint8_t width)
+{
+    int id = v->num_signals;
+
+    if (id >= VCD_MAX_SIGNALS)
+        return -1;
+    v->width[id] = width;
+    v->num_signals++;
+    if (width == 1)
+        fprintf(v->f, "$var wire 1 %c %s $end\n", '!' + id, name);
+    else
+        fprintf(v->f, "$var wire %u %c %s[%u:0] $end\n", width, '!' + id, name, width - 1);
+    return id;
+}
+
+/**
+ * @brief Ends the declarations.
+ */
+void vcd_begin(vcd_t *v)
+{
+    fprintf(v->f, "$upscope $end\n$enddefinitions $end\n");
+}
+
+/**
+ * @brief Returns the VCD character for one bit of a signal.
+ */
+static char bit_char(uint32_t value, uint32_t x_mask, uint32_t z_mask, uint8_t bit)
+{
+    if ((z_mask >> bit) & 1)
+        return 'z';
+    if ((x_mask >> bit) & 1)
+        return 'x';
+    return ((value >> bit) & 1) ? '1' : '0';
+}
+
+/**
+ * @brief Records the value of a signal from `time_ps` on, if it changed.
+ *
+ * @param v The dump.
+ * @param time_ps When the value took effect; never earlier than the last call.
+ * @param id The signal.
+ * @param value Its bits.
+ * @param x_mask Bits that are unknown.
+ * @param z_mask Bits that nothing drives.
+ */
+void vcd_set(vcd_t *v, uint64_t time_ps, int id, uint32_t value, uint32_t x_mask, uint32_t z_mask)
+{
+    uint32_t mask;
+    int bit;
+
+    if ((id < 0) || (id >= v->num_signals))
+        return;
+    mask = (v->width[id] < 32) ? (1u << v->width[id]) - 1 : 0xffffffff;
+    value &= mask;
+    x_mask &= mask;
+    z_mask &= mask;
+    if (v->written[id] && (v->value[id] == value) && (v->x_mask[id] == x_mask) && (v->z_mask[id] == z_mask))
+        return;
+
+    if (!v->time_written || (time_ps != v->time_ps)) {
+        fprintf(v->f, "#%llu\n", (unsigned long long)time_ps);
+        v->time_ps = time_ps;
+        v->time_written = true;
+    }
+    if (v->width[id] == 1) {
+        fprintf(v->f, "%c%c\n", bit_char(value, x_mask, z_mask, 0), '!' + id);
+    } else {
+        fputc('b', v->f);
+        for (bit = v->width[id] - 1; bit >= 0; bit--) {
+            fputc(bit_char(value, x_mask, z_mask, bit), v->f);
+        }
+        fprintf(v->f, " %c\n", '!' + id);
+    }
+    v->value[id] = value;
+    v->x_mask[id] = x_mask;
+    v->z_mask[id] = z_mask;
+    v->written[id] = true;
+}
+
+/**
+ * @brief Finishes the dump and closes its file.
+ */
+void vcd_close(vcd_t *v)
+{
+    if (v->f)
+        fclose(v->f);
+    v->f = NULL;
+}
@@ -0,0 +1,32 @@
+#ifndef VCD_H
+#define VCD_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#define VCD_MAX_SIGNALS 16
+
+/**
+ * @brief A Value Change Dump being written, with the last value of each signal.
+ */
+typedef struct {
+    FILE *f;
+    uint8_t num_signals;
+    uint8_t width[VCD_MAX_SIGNALS];
+    uint32_t value[VCD_MAX_SIGNALS];
+    uint32_t x_mask[VCD_MAX_SIGNALS];
+    uint32_t z_mask[VCD_MAX_SIGNALS];
+    bool written[VCD_MAX_SIGNALS];
+    uint64_t time_ps;   // Time of the last change written
+    bool time_written;
+} vcd_t;
+
+// Function prototypes
+bool vcd_open(vcd_t *v, const char *path, const char *module);
+int vcd_add(vcd_t *v, const char *name, uint8_t width);
+void vcd_begin(vcd_t *v);
+void vcd_set(vcd_t *v, uint64_t time_ps, int id, uint32_t value, uint32_t x_mask, uint32_t z_mask);
+void vcd_close(vcd_t *v);
+
+#endif // VCD_H
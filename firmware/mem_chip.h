@@ -1,6 +1,8 @@
 #ifndef MEMCHIP_H
 #define MEMCHIP_H
 
+#include "ram_timing.h"
+
 typedef struct {
     uint8_t num_variants;
     const char *variant_names[];
@@ -11,10 +13,25 @@ typedef struct {
     void (*teardown_pio)();
     int (*ram_read)(int addr);
     void (*ram_write)(int addr, int data);
+    uint32_t (*ram_encode)(int addr, int data, bool write);
+    void (*ram_read_block)(int addr, uint32_t *data, uint32_t count);
+    void (*ram_write_block)(int addr, const uint32_t *data, uint32_t count);
+    void (*ram_read_page)(int addr, uint32_t *data, uint32_t count);
+    void (*ram_write_page)(int addr, const uint32_t *data, uint32_t count);
     uint32_t mem_size;
     uint32_t bits;
+    uint8_t row_bits; // addr = col << row_bits | row
+    uint8_t bank_bits; // Low bits of the row that pick a die or RAS# line, not a physical row
+    bool page_mode;   // Program honours the fast page mode bit of the command word
+    uint16_t refresh_rows; // Refresh cycles the datasheet asks for in each refresh period
+    uint32_t refresh_us;   // Datasheet refresh period in microseconds
     const mem_chip_variants_t *variants;
+    const struct pio_program *program; // PIO program before its delays are patched
     uint8_t speed_grades;
+    const uint8_t (*delays)[32]; // PIO delay table, one row per speed grade, fastest first
+    uint8_t delay_fields;        // Number of delay fields in each row
+    const ram_timing_t *timings; // Datasheet timing of each speed grade, the delays are generated from it at build time
+    const ram_timing_rules_t *timing_rules; // How the timings map onto the delay fields
     const char *chip_name;
     const char *speed_names[];
 } mem_chip_t;
@@ -14,6 +14,32 @@
 uint16_t current_pio_instructions[32];
 // Structure to represent the currently active PIO program.
 struct pio_program current_pio_program;
+// The program as compiled, whose delay fields still hold field numbers
+static const struct pio_program *template_pio_program;
+// The delay table most recently patched in, and its number of fields
+static uint8_t current_delays[32];
+static uint8_t current_delay_fields;
+
+// Room for every speed grade of every chip's program, patched at boot
+#define PIO_CACHE_IMAGES 48
+
+/**
+ * @brief A program with one speed grade's delays already patched in.
+ */
+typedef struct {
+    const struct pio_program *prog; // The compiled program
+    const uint8_t *delays;          // The delay table row patched into it
+    uint16_t instructions[32];      // The patched instructions
+} pio_image_t;
+
+static pio_image_t pio_images[PIO_CACHE_IMAGES];
+static uint8_t pio_num_images;
+
+// Program left in instruction memory after the last test, and where it lives
+static const struct pio_program *resident_program;
+static PIO resident_pio;
+static uint resident_sm;
+static uint resident_offset;
 
 /**
  * @brief Copies a constant PIO program into an internal mutable buffer.
@@ -25,6 +51,7 @@ struct pio_program current_pio_program;
  */
 void set_current_pio_program(const struct pio_program *prog)
 {
+    template_pio_program = prog;
     // Copy instruction data
     memcpy(current_pio_instructions, prog->instructions, prog->length * sizeof(uint16_t));
     // Update the mutable PIO program structure to point to our buffer
@@ -48,6 +75,27 @@ struct pio_program *get_current_pio_program()
     return &current_pio_program;
 }
 
+/**
+ * @brief Replaces the delay field number of one instruction with its delay.
+ *
+ * @param instr The instruction, with a field number in its delay/sideset bits.
+ * @param delays The delay table, indexed by field number.
+ * @param length The number of elements in the `delays` array.
+ * @return The patched instruction.
+ */
+static uint16_t patch_delay(uint16_t instr, const uint8_t *delays, uint8_t length)
+{
+    // Extract the 5-bit delay/sideset field (bits 8-12) from the instruction
+    uint8_t field = (instr >> 8) & 0x1f;
+
+    // Check if the field is a valid index into the delays array (0 is reserved)
+    if ((field > 0) && (field < length)) {
+        // Mask out the existing field and insert the new delay value, masked to 5 bits
+        instr = (instr & 0xe0ff) | ((delays[field] & 0x1f) << 8);
+    }
+    return instr;
+}
+
 /**
  * @brief Patches the delay/sideset fields of the current PIO program instructions.
  *
@@ -63,24 +111,194 @@ struct pio_program *get_current_pio_program()
 void pio_patch_delays(const uint8_t *delays, uint8_t length)
 {
     uint8_t i;     // Loop counter for instructions
-    uint8_t field; // Extracted delay field from instruction
-    uint16_t instr; // Temporary variable to hold instruction during modification
+
+    // Remember the table so the delays can be reloaded around it later
+    memcpy(current_delays, delays, length);
+    current_delay_fields = length;
 
     // Iterate through each instruction in the current PIO program
-    for (i = 0; i < 31; i++) { // Assuming max 32 instructions, loop up to 31 for safety
-        // Extract the 5-bit delay/sideset field (bits 8-12) from the instruction
-        field = (current_pio_instructions[i] >> 8) & 0x1f;
-
-        // Check if the field is a valid index into the delays array (0 is reserved)
-        if ((field > 0) && (field < length)) {
-            // Mask out the existing delay/sideset field (bits 8-12)
-            instr = current_pio_instructions[i] & 0xe0ff;
-            // Insert the new delay value from the `delays` array into the instruction
-            // The new delay value is masked to 5 bits (0x1f) and shifted into position
-            instr |= ((delays[field] & 0x1f) << 8);
-            // Update the instruction in the buffer
-            current_pio_instructions[i] = instr;
+    for (i = 0; i < current_pio_program.length; i++) {
+        current_pio_instructions[i] = patch_delay(current_pio_instructions[i], delays, length);
+    }
+}
+
+/**
+ * @brief Finds the cached image of a program patched with a delay table row.
+ *
+ * @param prog The compiled program.
+ * @param delays The delay table row.
+ * @return The patched instructions, or NULL if that pair was never cached.
+ */
+static const uint16_t *find_image(const struct pio_program *prog, const uint8_t *delays)
+{
+    uint8_t i;
+
+    for (i = 0; i < pio_num_images; i++) {
+        if ((pio_images[i].prog == prog) && (pio_images[i].delays == delays))
+            return pio_images[i].instructions;
+    }
+    return NULL;
+}
+
+/**
+ * @brief Makes `prog` with `delays` patched in the current program.
+ *
+ * Uses the cached image when there is one, else patches the compiled program.
+ *
+ * @param prog The compiled program.
+ * @param delays The delay table.
+ * @param length The number of elements in the `delays` array.
+ */
+static void load_image(const struct pio_program *prog, const uint8_t *delays, uint8_t length)
+{
+    const uint16_t *image = find_image(prog, delays);
+
+    set_current_pio_program(prog);
+    if (image) {
+        memcpy(current_pio_instructions, image, prog->length * sizeof(uint16_t));
+        memcpy(current_delays, delays, length);
+        current_delay_fields = length;
+    } else {
+        pio_patch_delays(delays, length);
+    }
+}
+
+/**
+ * @brief Writes the delay-bearing instructions of the current program to instruction memory.
+ *
+ * The other instructions never change, so a program that is already loaded
+ * only needs these rewritten to take on new delays.
+ *
+ * @param pio The PIO block holding the program.
+ * @param offset Where the program was loaded.
+ */
+static void write_delay_instructions(PIO pio, uint offset)
+{
+    const struct pio_program *prog = template_pio_program;
+    uint16_t instr;
+    uint8_t field;
+    uint8_t i;
+
+    for (i = 0; i < prog->length; i++) {
+        field = (prog->instructions[i] >> 8) & 0x1f;
+        if ((field == 0) || (field >= current_delay_fields))
+            continue;
+        instr = current_pio_instructions[i];
+        // Relocate jumps the same way pio_add_program does
+        pio->instr_mem[offset + i] = ((instr & 0xe000) == 0) ? instr + offset : instr;
+    }
+}
+
+/**
+ * @brief Patches every speed grade of a program ahead of time.
+ *
+ * Called for each chip at boot, so that loading a grade later is a copy.
+ * Tables shared by several chips are only cached once.
+ *
+ * @param prog The compiled program.
+ * @param delays The delay table, one row per speed grade.
+ * @param grades The number of rows in `delays`.
+ * @param length The number of delay fields in each row.
+ */
+void pio_cache_add(const struct pio_program *prog, const uint8_t (*delays)[32], uint8_t grades, uint8_t length)
+{
+    pio_image_t *img;
+    uint8_t grade;
+    uint8_t i;
+
+    for (grade = 0; grade < grades; grade++) {
+        if (find_image(prog, delays[grade]) || (pio_num_images >= PIO_CACHE_IMAGES))
+            continue;
+        img = &pio_images[pio_num_images++];
+        img->prog = prog;
+        img->delays = delays[grade];
+        for (i = 0; i < prog->length; i++) {
+            img->instructions[i] = patch_delay(prog->instructions[i], delays[grade], length);
         }
     }
 }
 
+/**
+ * @brief Loads a program with a delay table patched in, claiming a state machine for it.
+ *
+ * The program stays in instruction memory after the test. Loading the same
+ * program again, at any speed grade, only rewrites its delay-bearing
+ * instructions in place and reuses the state machine. Loading a different
+ * program removes the old one first.
+ *
+ * @param prog The compiled program.
+ * @param delays The delay table.
+ * @param length The number of elements in the `delays` array.
+ * @param pio Receives the PIO block holding the program.
+ * @param sm Receives the state machine claimed for it.
+ * @param offset Receives where the program was loaded.
+ * @param pin The first GPIO the program uses.
+ * @param pin_count The number of GPIOs the program uses.
+ * @return True on success, false if no state machine or space was free.
+ */
+bool pio_load_program(const struct pio_program *prog, const uint8_t *delays, uint8_t length,
+                      PIO *pio, uint *sm, uint *offset, uint pin, uint pin_count)
+{
+    if (resident_program == prog) {
+        pio_sm_set_enabled(resident_pio, resident_sm, false);
+        load_image(prog, delays, length);
+        write_delay_instructions(resident_pio, resident_offset);
+        *pio = resident_pio;
+        *sm = resident_sm;
+        *offset = resident_offset;
+        return true;
+    }
+
+    if (resident_program) {
+        pio_sm_set_enabled(resident_pio, resident_sm, false);
+        pio_remove_program_and_unclaim_sm(resident_program, resident_pio, resident_sm, resident_offset);
+        resident_program = NULL;
+    }
+    load_image(prog, delays, length);
+    if (!pio_claim_free_sm_and_add_program_for_gpio_range(&current_pio_program, pio, sm, offset,
+                                                          pin, pin_count, true))
+        return false;
+    resident_program = prog;
+    resident_pio = *pio;
+    resident_sm = *sm;
+    resident_offset = *offset;
+    return true;
+}
+
+/**
+ * @brief Returns the delay table most recently patched into the current program.
+ *
+ * @param delays Buffer of 32 entries receiving the table.
+ * @return The number of delay fields in the table.
+ */
+uint8_t pio_get_delays(uint8_t *delays)
+{
+    memcpy(delays, current_delays, sizeof(current_delays));
+    return current_delay_fields;
+}
+
+/**
+ * @brief Patches new delays straight into a program that is already loaded.
+ *
+ * Rebuilds the program from the compiled one, so any delay table can be
+ * applied any number of times, and rewrites its delay-bearing instructions
+ * at `offset`. The state machine is stopped while the program changes and
+ * restarted from the top, so it must be idle (no commands in flight).
+ *
+ * @param pio The PIO block holding the program.
+ * @param sm The state machine running it.
+ * @param offset Where the program was loaded.
+ * @param delays The new delay table.
+ * @param length The number of elements in the `delays` array.
+ */
+void pio_reload_delays(PIO pio, uint sm, uint offset, const uint8_t *delays, uint8_t length)
+{
+    pio_sm_set_enabled(pio, sm, false);
+    load_image(template_pio_program, delays, length);
+    write_delay_instructions(pio, offset);
+    pio_sm_clear_fifos(pio, sm);
+    pio_sm_restart(pio, sm);
+    pio_sm_exec(pio, sm, pio_encode_jmp(offset));
+    pio_sm_set_enabled(pio, sm, true);
+}
+
@@ -4,6 +4,11 @@
 void set_current_pio_program(const struct pio_program *prog);
 struct pio_program *get_current_pio_program();
 void pio_patch_delays(const uint8_t *delays, uint8_t length);
+uint8_t pio_get_delays(uint8_t *delays);
+void pio_cache_add(const struct pio_program *prog, const uint8_t (*delays)[32], uint8_t grades, uint8_t length);
+bool pio_load_program(const struct pio_program *prog, const uint8_t *delays, uint8_t length,
+                      PIO *pio, uint *sm, uint *offset, uint pin, uint pin_count);
+void pio_reload_delays(PIO pio, uint sm, uint offset, const uint8_t *delays, uint8_t length);
 
 
 #endif
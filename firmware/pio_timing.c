@@ -0,0 +1,88 @@
+/*
+ * pio_timing.c
+ *
+ * Runtime choice of the clock the DRAM state machines run at. Every delay
+ * field is a whole number of PIO cycles, so at a fixed 300 MHz each timing
+ * is rounded up to the next 3.3ns. Given the datasheet timing of a grade,
+ * this generates its delays at each system clock up to the one the chips
+ * were characterized at, and picks the clock whose rounding leaves the
+ * shortest random access cycle. The generator counts every cycle of each interval, so
+ * the delays meet the datasheet at whichever clock is chosen.
+ */
+
+#include <string.h>
+#include "pio_timing.h"
+#include "pico/stdlib.h"
+#include "hardware/clocks.h"
+
+// Clocks tried, fastest first; any the PLL cannot make exactly are skipped
+static const uint32_t pio_timing_khz[] = {300000, 294000, 288000, 282000, 276000, 270000,
+                                          264000, 258000, 252000, 246000, 240000};
+
+#define PIO_TIMING_CLOCKS (sizeof(pio_timing_khz) / sizeof(pio_timing_khz[0]))
+
+/**
+ * @brief Returns the time of the interval a timing parameter constrains.
+ *
+ * @param rules How the timing maps onto the program's delay fields.
+ * @param param The parameter, RAM_TRC for a random access cycle or RAM_TCP for a page mode step.
+ * @param delays The delay table patched into the program.
+ * @param sys_khz The clock it runs at.
+ * @return The interval in picoseconds, or 0 if no rule names the parameter.
+ */
+uint32_t pio_timing_interval_ps(const ram_timing_rules_t *rules, ram_timing_param_t param, const uint8_t *delays,
+                                uint32_t sys_khz)
+{
+    return (uint32_t)(ram_timing_interval(rules, param, delays) * 1000000000ULL / sys_khz);
+}
+
+/**
+ * @brief Picks the clock that meets a grade's timing with the shortest access cycle.
+ *
+ * Clocks are ranked by the interval of the program's tRC rule, a whole
+ * random access from RAS# falling to the next, rather than by the length of
+ * the program: a read or a write runs only its own branch, and page mode
+ * steps skip the row part. Ties go to the faster clock. The base clock
+ * always qualifies, since the built-in delay tables were generated for it.
+ *
+ * @param timing_ns The datasheet timing of the grade.
+ * @param rules How the timing maps onto the program's delay fields.
+ * @param timing Receives the chosen clock, its delays and the cycle time.
+ */
+void pio_timing_select(const ram_timing_t *timing_ns, const ram_timing_rules_t *rules, pio_timing_t *timing)
+{
+    uint8_t delays[32];
+    uint32_t vco, postdiv1, postdiv2;
+    uint32_t trc_ps;
+    uint32_t i;
+
+    timing->sys_khz = 0;
+    timing->trc_ps = UINT32_MAX;
+    for (i = 0; i < PIO_TIMING_CLOCKS; i++) {
+        if (!check_sys_clock_khz(pio_timing_khz[i], &vco, &postdiv1, &postdiv2))
+            continue;
+        if (!ram_timing_generate(timing_ns, rules, pio_timing_khz[i], delays))
+            continue;
+        trc_ps = pio_timing_interval_ps(rules, RAM_TRC, delays, pio_timing_khz[i]);
+        if (trc_ps < timing->trc_ps) {
+            timing->sys_khz = pio_timing_khz[i];
+            timing->trc_ps = trc_ps;
+            memcpy(timing->delays, delays, sizeof(delays));
+        }
+    }
+}
+
+/**
+ * @brief Switches the system clock, and with it the PIO clock.
+ *
+ * Only call this while core1 is idle. The peripheral clock follows the
+ * system clock, so the LCD's SPI slows down in proportion; the microsecond
+ * timer runs from the reference clock and is unaffected.
+ *
+ * @param sys_khz The new clock, one that check_sys_clock_khz accepts.
+ */
+void pio_timing_apply(uint32_t sys_khz)
+{
+    if (sys_khz && (clock_get_hz(clk_sys) != sys_khz * 1000))
+        set_sys_clock_khz(sys_khz, true);
+}
@@ -0,0 +1,27 @@
+#ifndef PIO_TIMING_H
+#define PIO_TIMING_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "hardware/pio.h"
+#include "ram_timing.h"
+
+// System clock the delay tables are generated for at build time, set by PLL_SYS_* in CMakeLists.txt
+#define PIO_TIMING_BASE_KHZ 300000
+
+/**
+ * @brief A PIO clock and the delays that meet a grade's datasheet timing at it.
+ */
+typedef struct {
+    uint32_t sys_khz;   // System (and so PIO) clock
+    uint32_t trc_ps;    // Random access cycle, the tRC rule's interval, at that clock
+    uint8_t delays[32]; // Delay table quantized to that clock
+} pio_timing_t;
+
+// Function prototypes
+uint32_t pio_timing_interval_ps(const ram_timing_rules_t *rules, ram_timing_param_t param, const uint8_t *delays,
+                                uint32_t sys_khz);
+void pio_timing_select(const ram_timing_t *timing_ns, const ram_timing_rules_t *rules, pio_timing_t *timing);
+void pio_timing_apply(uint32_t sys_khz);
+
+#endif // PIO_TIMING_H
@@ -24,6 +24,7 @@
 #include "mem_chip.h"
 #include "xoroshiro64starstar.h"
 #include "dram_tests.h"
+#include "split_verify.h"
 #include "ui.h"
 
 /**
@@ -77,6 +78,13 @@ void core1_entry() {
 
     psrand_init_seeds(); // Initialize pseudo-random number generator seeds
 
+    // Patch every speed grade of every chip's PIO program up front. The delay
+    // tables were generated from the datasheet timings when the firmware was built.
+    for (i = 0; i < NUM_CHIPS; i++) {
+        pio_cache_add(chip_list[i]->program, chip_list[i]->delays, chip_list[i]->speed_grades,
+                      chip_list[i]->delay_fields);
+    }
+
     // Initialize onboard LED
     gpio_init(GPIO_LED);
     gpio_set_dir(GPIO_LED, GPIO_OUT);
@@ -113,6 +121,7 @@ void core1_entry() {
         do_encoder(); // Handle rotary encoder input
         do_buttons(); // Handle button presses
         do_status();  // Update UI status and check for test completion
+        split_verify_poll(); // Check read results handed over by core1, if any
     }
 
     return 0; // Should not be reached in a typical embedded application
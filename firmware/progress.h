@@ -0,0 +1,63 @@
+#ifndef PROGRESS_H
+#define PROGRESS_H
+
+#include <stdint.h>
+#include "hardware/sync.h"
+
+// Addresses between publishes in loops that visit one address at a time
+#define PROGRESS_INTERVAL 1024
+
+// Position of the running test, as shown by the visualization
+typedef struct {
+    uint32_t addr;    // Progress through the current pass, in addresses
+    uint32_t bit;     // Data bit or background being tested
+    uint32_t subtest; // Phase within the current test
+} progress_t;
+
+// Progress shared between cores. Core1 is the only writer; `seq` is odd
+// while an update is in progress so readers can retry instead of tearing.
+typedef struct {
+    volatile uint32_t seq;
+    volatile uint32_t addr;
+    volatile uint32_t bit;
+    volatile uint32_t subtest;
+} progress_block_t;
+
+/**
+ * @brief Publishes a new progress value. Must only be called by the writer.
+ *
+ * @param b The shared progress block.
+ * @param p The progress to publish.
+ */
+static inline void progress_publish(progress_block_t *b, const progress_t *p)
+{
+    b->seq = b->seq + 1; // Odd: update in progress
+    __dmb();
+    b->addr = p->addr;
+    b->bit = p->bit;
+    b->subtest = p->subtest;
+    __dmb();
+    b->seq = b->seq + 1; // Even: update complete
+}
+
+/**
+ * @brief Takes a consistent snapshot of the shared progress.
+ *
+ * @param b The shared progress block.
+ * @param p Receives the snapshot.
+ */
+static inline void progress_snapshot(const progress_block_t *b, progress_t *p)
+{
+    uint32_t seq;
+
+    do {
+        seq = b->seq;
+        __dmb();
+        p->addr = b->addr;
+        p->bit = b->bit;
+        p->subtest = b->subtest;
+        __dmb();
+    } while ((seq & 1) || (seq != b->seq));
+}
+
+#endif //PROGRESS_H
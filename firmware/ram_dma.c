@@ -0,0 +1,172 @@
+/*
+ * ram_dma.c
+ *
+ * DMA transport for the DRAM state machine. One channel, paced by the TX
+ * DREQ, copies encoded command words from SRAM into the TX FIFO. A second
+ * channel, paced by the RX DREQ, copies every result word out of the RX
+ * FIFO. The CPU only has to build command buffers and check results.
+ * For CRC verification the result channel feeds the DMA sniffer instead
+ * of memory, and a third channel checksums the expected data the same way.
+ */
+
+#include "ram_dma.h"
+#include "app_state.h"
+#include "hardware/dma.h"
+#include "hardware/pio.h"
+
+// Channels are claimed on first use and kept for the life of the program
+static int ram_dma_tx_chan = -1;
+static int ram_dma_rx_chan = -1;
+static int ram_dma_crc_chan = -1;
+
+// Sink for the dummy results of writes
+static uint32_t ram_dma_discard;
+
+/**
+ * @brief Claims the DMA channels if that has not been done yet.
+ */
+static void ram_dma_claim()
+{
+    if (ram_dma_tx_chan < 0) {
+        ram_dma_tx_chan = dma_claim_unused_channel(true);
+        ram_dma_rx_chan = dma_claim_unused_channel(true);
+        ram_dma_crc_chan = dma_claim_unused_channel(true);
+    }
+}
+
+/**
+ * @brief Arms the RX and TX channels for a command buffer.
+ *
+ * The RX channel is armed before the TX channel so that no result can be
+ * pushed before something is ready to take it. Every command returns one
+ * result word, so the RX FIFO is drained as fast as the program fills it.
+ *
+ * @param cmds The `count` encoded command words.
+ * @param results Buffer receiving `count` result words, or NULL to discard them.
+ * @param count The number of commands.
+ * @param sniff True to run the results through the sniffer's CRC32.
+ */
+static void ram_dma_arm(const uint32_t *cmds, uint32_t *results, uint32_t count, bool sniff)
+{
+    dma_channel_config c;
+
+    ram_dma_claim();
+
+    c = dma_channel_get_default_config(ram_dma_rx_chan);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_32);
+    channel_config_set_read_increment(&c, false);
+    channel_config_set_write_increment(&c, results != NULL);
+    channel_config_set_dreq(&c, pio_get_dreq(pio, sm, false));
+    if (sniff) {
+        channel_config_set_sniff_enable(&c, true);
+        dma_sniffer_set_data_accumulator(RAM_DMA_CRC_SEED);
+        dma_sniffer_enable(ram_dma_rx_chan, DMA_SNIFF_CTRL_CALC_VALUE_CRC32, true);
+    }
+    dma_channel_configure(ram_dma_rx_chan, &c, results ? results : &ram_dma_discard,
+                          &pio->rxf[sm], count, true);
+
+    c = dma_channel_get_default_config(ram_dma_tx_chan);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_32);
+    channel_config_set_read_increment(&c, true);
+    channel_config_set_write_increment(&c, false);
+    channel_config_set_dreq(&c, pio_get_dreq(pio, sm, true));
+    dma_channel_configure(ram_dma_tx_chan, &c, &pio->txf[sm], cmds, count, true);
+}
+
+/**
+ * @brief Starts streaming a command buffer to the current state machine.
+ *
+ * @param cmds The `count` encoded command words.
+ * @param results Buffer receiving `count` result words, or NULL to discard them.
+ * @param count The number of commands.
+ */
+void ram_dma_start(const uint32_t *cmds, uint32_t *results, uint32_t count)
+{
+    ram_dma_arm(cmds, results, count, false);
+}
+
+/**
+ * @brief Starts a read stream whose results only feed the sniffer's CRC32.
+ *
+ * The results are not stored anywhere. Once `ram_dma_wait` returns,
+ * `ram_dma_sniffed_crc` gives the CRC of everything that was read.
+ *
+ * @param cmds The `count` encoded read commands.
+ * @param count The number of commands.
+ */
+void ram_dma_start_sniffed(const uint32_t *cmds, uint32_t count)
+{
+    ram_dma_arm(cmds, NULL, count, true);
+}
+
+/**
+ * @brief Returns the CRC32 of the results of the last sniffed stream.
+ *
+ * @return The sniffer's accumulator.
+ */
+uint32_t ram_dma_sniffed_crc()
+{
+    return dma_sniffer_get_data_accumulator();
+}
+
+/**
+ * @brief Computes the sniffer's CRC32 over a buffer in memory.
+ *
+ * Copies the words to a sink through the sniffer, so the result matches
+ * `ram_dma_sniffed_crc` for a stream that read the same words. Must not
+ * be called while a sniffed stream is running.
+ *
+ * @param src The words to checksum.
+ * @param count The number of words.
+ * @param increment False to checksum `count` copies of `*src`.
+ * @return The CRC32.
+ */
+uint32_t ram_dma_crc(const uint32_t *src, uint32_t count, bool increment)
+{
+    static uint32_t sink;
+    dma_channel_config c;
+
+    ram_dma_claim();
+
+    c = dma_channel_get_default_config(ram_dma_crc_chan);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_32);
+    channel_config_set_read_increment(&c, increment);
+    channel_config_set_write_increment(&c, false);
+    channel_config_set_sniff_enable(&c, true);
+    dma_sniffer_set_data_accumulator(RAM_DMA_CRC_SEED);
+    dma_sniffer_enable(ram_dma_crc_chan, DMA_SNIFF_CTRL_CALC_VALUE_CRC32, true);
+    dma_channel_configure(ram_dma_crc_chan, &c, &sink, src, count, true);
+    dma_channel_wait_for_finish_blocking(ram_dma_crc_chan);
+    return dma_sniffer_get_data_accumulator();
+}
+
+/**
+ * @brief Waits until every result of the last `ram_dma_start` has landed.
+ */
+void ram_dma_wait()
+{
+    dma_channel_wait_for_finish_blocking(ram_dma_rx_chan);
+}
+
+/**
+ * @brief Checks whether the last transfer is still running.
+ *
+ * @return True while results are still outstanding.
+ */
+bool ram_dma_busy()
+{
+    return dma_channel_is_busy(ram_dma_rx_chan);
+}
+
+/**
+ * @brief Streams a command buffer and waits for all of its results.
+ *
+ * @param cmds The `count` encoded command words.
+ * @param results Buffer receiving `count` result words, or NULL to discard them.
+ * @param count The number of commands.
+ */
+void ram_dma_xfer(const uint32_t *cmds, uint32_t *results, uint32_t count)
+{
+    ram_dma_start(cmds, results, count);
+    ram_dma_wait();
+}
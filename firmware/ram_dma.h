@@ -0,0 +1,25 @@
+#ifndef RAM_DMA_H
+#define RAM_DMA_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// How block transfers reach the DRAM state machine
+typedef enum {
+    RAM_TRANSPORT_POLLED, // Core1 feeds the FIFOs with pio_sm_put/pio_sm_get
+    RAM_TRANSPORT_DMA     // Two DMA channels move whole command/result buffers
+} ram_transport_t;
+
+// Initial value of the sniffer's CRC32
+#define RAM_DMA_CRC_SEED 0xffffffff
+
+// Function prototypes
+void ram_dma_start(const uint32_t *cmds, uint32_t *results, uint32_t count);
+void ram_dma_wait();
+bool ram_dma_busy();
+void ram_dma_xfer(const uint32_t *cmds, uint32_t *results, uint32_t count);
+void ram_dma_start_sniffed(const uint32_t *cmds, uint32_t count);
+uint32_t ram_dma_sniffed_crc();
+uint32_t ram_dma_crc(const uint32_t *src, uint32_t count, bool increment);
+
+#endif //RAM_DMA_H
@@ -0,0 +1,90 @@
+/*
+ * ram_refresh.c
+ *
+ * Background refresh for the DRAM under test. The state machines only
+ * refresh the rows that the tests happen to touch, so a long pass over a
+ * big part can leave rows unaccessed for far longer than the refresh spec.
+ * This scheduler gives each row a deadline and, whenever the tests poll it
+ * between blocks, injects read cycles into the same FIFO for every row that
+ * is due. Each read opens its row and so refreshes it, like a RAS-only cycle.
+ */
+
+#include "ram_refresh.h"
+#include "app_state.h"
+#include "row_age.h"
+#include "hardware/pio.h"
+
+bool ram_refresh_on;
+uint32_t ram_refresh_next_us;
+
+// Row refreshed next, and the number of rows and time between them
+static uint32_t ram_refresh_row;
+static uint32_t ram_refresh_rows;
+static uint32_t ram_refresh_interval_us;
+
+/**
+ * @brief Starts refreshing every row of a chip at its datasheet refresh rate.
+ *
+ * @param chip The chip under test.
+ */
+void ram_refresh_start(const mem_chip_t *chip)
+{
+    ram_refresh_rows = 1 << chip->row_bits;
+    ram_refresh_row = 0;
+    // Round down so every refresh cycle is always made within the period
+    ram_refresh_interval_us = MAX(chip->refresh_us / chip->refresh_rows, 1);
+    ram_refresh_next_us = time_us_32();
+    ram_refresh_on = true;
+}
+
+/**
+ * @brief Stops the background refresh.
+ */
+void ram_refresh_stop()
+{
+    ram_refresh_on = false;
+}
+
+/**
+ * @brief Turns the background refresh on or off for a test that needs it off.
+ *
+ * Rows owed while it was off are caught up on the next service call.
+ *
+ * @param enabled True to refresh.
+ * @return The previous setting, for restoring afterwards.
+ */
+bool ram_refresh_set_enabled(bool enabled)
+{
+    bool was = ram_refresh_on;
+
+    ram_refresh_on = enabled && (ram_refresh_rows != 0);
+    return was;
+}
+
+/**
+ * @brief Refreshes every row whose deadline has passed.
+ *
+ * After a long gap at most one full sweep of the rows is made and the
+ * schedule restarts from now.
+ */
+void ram_refresh_catch_up()
+{
+    const mem_chip_t *chip = chip_list[main_menu.sel_line];
+    uint32_t now = time_us_32();
+    uint32_t owed = (now - ram_refresh_next_us) / ram_refresh_interval_us + 1;
+    uint32_t i;
+
+    if (owed >= ram_refresh_rows) {
+        owed = ram_refresh_rows;
+        ram_refresh_next_us = now - (owed - 1) * ram_refresh_interval_us;
+    }
+
+    for (i = 0; i < owed; i++) {
+        row_age_touch(ram_refresh_row);
+        pio_sm_put(pio, sm, chip->ram_encode(ram_refresh_row, 0, false));
+        while (pio_sm_is_rx_fifo_empty(pio, sm)) {} // Wait for the cycle to finish
+        pio_sm_get(pio, sm);                        // Discard the data
+        ram_refresh_row = (ram_refresh_row + 1) & (ram_refresh_rows - 1);
+    }
+    ram_refresh_next_us += owed * ram_refresh_interval_us;
+}
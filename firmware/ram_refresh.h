@@ -0,0 +1,59 @@
+#ifndef RAM_REFRESH_H
+#define RAM_REFRESH_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "pico/stdlib.h"
+#include "mem_chip.h"
+
+// Scheduler state, kept here so the deadline check inlines into the test loops
+extern bool ram_refresh_on;
+extern uint32_t ram_refresh_next_us;
+
+// Function prototypes
+void ram_refresh_start(const mem_chip_t *chip);
+void ram_refresh_stop();
+bool ram_refresh_set_enabled(bool enabled);
+void ram_refresh_catch_up();
+
+/**
+ * @brief Returns the longest the background refresh leaves any row address unopened.
+ *
+ * Rows are refreshed at the rate of the datasheet's refresh cycles, but
+ * every row address is swept in case the part decodes them all, so on a
+ * part with fewer refresh cycles than row addresses a sweep takes longer
+ * than the refresh period. Each row the part does refresh is still opened
+ * within the period.
+ *
+ * @param chip The chip.
+ * @return The sweep time in microseconds.
+ */
+static inline uint32_t ram_refresh_period_us(const mem_chip_t *chip)
+{
+    return (chip->refresh_us / chip->refresh_rows) << chip->row_bits;
+}
+
+/**
+ * @brief Checks whether any row is due for refresh.
+ *
+ * @return True if `ram_refresh_catch_up` should be called.
+ */
+static inline bool ram_refresh_due()
+{
+    return ram_refresh_on && ((int32_t)(time_us_32() - ram_refresh_next_us) >= 0);
+}
+
+/**
+ * @brief Refreshes any rows whose deadline has passed.
+ *
+ * Must only be called while no commands are in flight, and never in the
+ * middle of a fast page mode burst. Costs one timer read when nothing is due.
+ */
+static inline void ram_refresh_service()
+{
+    if (ram_refresh_due()) {
+        ram_refresh_catch_up();
+    }
+}
+
+#endif //RAM_REFRESH_H
@@ -0,0 +1,263 @@
+#ifndef RAM_STREAM_H
+#define RAM_STREAM_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "pico/stdlib.h"
+#include "hardware/pio.h"
+#include "app_state.h"
+#include "row_age.h"
+
+// Maximum number of commands in flight in the state machine. This is bounded
+// by the RX FIFO depth so the `push noblock` at the end of every access can
+// never find the FIFO full and drop a result.
+#define RAM_STREAM_DEPTH 4
+
+// Encodes one access into the command word understood by a chip's PIO program
+typedef uint32_t (*ram_encode_fn)(int addr, int data, bool write);
+
+/**
+ * @brief Streams reads of a run of consecutive addresses through the PIO FIFOs.
+ *
+ * Keeps up to `RAM_STREAM_DEPTH` commands queued so the state machine never
+ * waits on the CPU between accesses. Results are drained in issue order.
+ * Forced inline so that each chip's encoder is inlined into its block routine.
+ *
+ * @param encode The chip's command encoder.
+ * @param addr The first address of the run.
+ * @param data Buffer receiving `count` data words.
+ * @param count The number of addresses to read.
+ */
+static __force_inline void ram_stream_read_run(ram_encode_fn encode, int addr,
+                                               uint32_t *data, uint32_t count)
+{
+    uint32_t issued = 0;
+    uint32_t done = 0;
+
+    while (done < count) {
+        if ((issued < count) && (issued - done < RAM_STREAM_DEPTH)) {
+            pio_sm_put(pio, sm, encode(addr + issued, 0, false));
+            issued++;
+        }
+        if (!pio_sm_is_rx_fifo_empty(pio, sm)) {
+            data[done++] = pio_sm_get(pio, sm);
+        }
+    }
+}
+
+/**
+ * @brief Streams writes to a run of consecutive addresses through the PIO FIFOs.
+ *
+ * Same pipelining as `ram_stream_read_run`; the dummy result of each write
+ * is drained and discarded.
+ *
+ * @param encode The chip's command encoder.
+ * @param addr The first address of the run.
+ * @param data The `count` data words to write.
+ * @param count The number of addresses to write.
+ */
+static __force_inline void ram_stream_write_run(ram_encode_fn encode, int addr,
+                                                const uint32_t *data, uint32_t count)
+{
+    uint32_t issued = 0;
+    uint32_t done = 0;
+
+    while (done < count) {
+        if ((issued < count) && (issued - done < RAM_STREAM_DEPTH)) {
+            pio_sm_put(pio, sm, encode(addr + issued, data[issued], true));
+            issued++;
+        }
+        if (!pio_sm_is_rx_fifo_empty(pio, sm)) {
+            pio_sm_get(pio, sm); // Discard the dummy data
+            done++;
+        }
+    }
+}
+
+// Bit 0 of the command word in the page-capable programs. When set, RAS# is
+// held low after the access and the next command is a CAS-only cycle that
+// reuses the open row.
+#define RAM_CMD_PAGE 1
+
+// Longest run of accesses made under a single RAS# low period. Keeps tRAS
+// well inside the ~10us maximum of the slowest supported parts.
+#define RAM_PAGE_BURST 16
+
+/**
+ * @brief Returns the page flag for the `index`th access of a column walk.
+ *
+ * The flag is set on every access that is followed by another one in the same
+ * burst, so each burst starts with a full RAS cycle and the rest are CAS only.
+ */
+static __force_inline uint32_t ram_stream_page_flag(uint32_t index, uint32_t count)
+{
+    return ((index + 1 < count) && ((index + 1) % RAM_PAGE_BURST != 0)) ? RAM_CMD_PAGE : 0;
+}
+
+/**
+ * @brief Streams reads along the columns of one row.
+ *
+ * Accesses `addr`, `addr + stride`, `addr + 2 * stride`... where `stride`
+ * steps the column address by one. With `page` set the row is opened once
+ * per `RAM_PAGE_BURST` accesses and the rest run as fast page mode cycles.
+ *
+ * @param encode The chip's command encoder.
+ * @param addr The first address of the walk.
+ * @param stride The address step between neighbouring columns.
+ * @param data Buffer receiving `count` data words.
+ * @param count The number of columns to read.
+ * @param page True if the chip's program supports fast page mode.
+ */
+static __force_inline void ram_stream_read_page_run(ram_encode_fn encode, int addr, int stride,
+                                                    uint32_t *data, uint32_t count, bool page)
+{
+    uint32_t issued = 0;
+    uint32_t done = 0;
+    uint32_t cmd;
+
+    while (done < count) {
+        if ((issued < count) && (issued - done < RAM_STREAM_DEPTH)) {
+            cmd = encode(addr + issued * stride, 0, false);
+            if (page) {
+                cmd |= ram_stream_page_flag(issued, count);
+            }
+            pio_sm_put(pio, sm, cmd);
+            issued++;
+        }
+        if (!pio_sm_is_rx_fifo_empty(pio, sm)) {
+            data[done++] = pio_sm_get(pio, sm);
+        }
+    }
+}
+
+/**
+ * @brief Streams writes along the columns of one row.
+ *
+ * See `ram_stream_read_page_run`.
+ *
+ * @param encode The chip's command encoder.
+ * @param addr The first address of the walk.
+ * @param stride The address step between neighbouring columns.
+ * @param data The `count` data words to write.
+ * @param count The number of columns to write.
+ * @param page True if the chip's program supports fast page mode.
+ */
+static __force_inline void ram_stream_write_page_run(ram_encode_fn encode, int addr, int stride,
+                                                     const uint32_t *data, uint32_t count, bool page)
+{
+    uint32_t issued = 0;
+    uint32_t done = 0;
+    uint32_t cmd;
+
+    while (done < count) {
+        if ((issued < count) && (issued - done < RAM_STREAM_DEPTH)) {
+            cmd = encode(addr + issued * stride, data[issued], true);
+            if (page) {
+                cmd |= ram_stream_page_flag(issued, count);
+            }
+            pio_sm_put(pio, sm, cmd);
+            issued++;
+        }
+        if (!pio_sm_is_rx_fifo_empty(pio, sm)) {
+            pio_sm_get(pio, sm); // Discard the dummy data
+            done++;
+        }
+    }
+}
+
+// Expected value for commands whose result is not checked (writes)
+#define RAM_STREAM_NO_CHECK 0xffffffff
+
+// Called with the address and mismatched data bits of each failing read
+typedef void (*ram_fail_fn)(uint32_t addr, uint32_t bad_bits);
+
+// A stream of mixed reads and writes in arbitrary address order. Each command
+// carries the value its result should have; reads are checked as the results
+// drain, so the CPU can keep encoding while the state machine is busy.
+typedef struct {
+    uint32_t expect[RAM_STREAM_DEPTH]; // Expected data for the commands in flight
+    uint32_t addr[RAM_STREAM_DEPTH];   // Addresses of the commands in flight
+    uint32_t mask;                     // Data bits compared on each read
+    uint32_t issued;                   // Commands pushed to the TX FIFO
+    uint32_t done;                     // Results drained from the RX FIFO
+    uint32_t failures;                 // Number of reads that did not match
+    uint32_t fail_bits;                // Data bits that have mismatched on any read
+    ram_fail_fn on_fail;               // Failure callback, or NULL
+} ram_check_stream_t;
+
+/**
+ * @brief Starts a new checked stream.
+ *
+ * @param s The stream state.
+ * @param mask Data bits compared on each read.
+ * @param on_fail Called for every failing read, or NULL.
+ */
+static inline void ram_check_stream_init(ram_check_stream_t *s, uint32_t mask, ram_fail_fn on_fail)
+{
+    s->mask = mask;
+    s->on_fail = on_fail;
+    s->issued = 0;
+    s->done = 0;
+    s->failures = 0;
+    s->fail_bits = 0;
+}
+
+/**
+ * @brief Waits for the oldest command in flight and checks its result.
+ *
+ * @param s The stream state.
+ */
+static __force_inline void ram_check_stream_drain_one(ram_check_stream_t *s)
+{
+    uint32_t d;
+    uint32_t e;
+
+    while (pio_sm_is_rx_fifo_empty(pio, sm)) {} // Wait for data to arrive
+    d = pio_sm_get(pio, sm);
+    e = s->expect[s->done % RAM_STREAM_DEPTH];
+    if ((e != RAM_STREAM_NO_CHECK) && ((d & s->mask) != e)) {
+        s->failures++;
+        s->fail_bits |= (d & s->mask) ^ e;
+        if (s->on_fail) {
+            s->on_fail(s->addr[s->done % RAM_STREAM_DEPTH], (d & s->mask) ^ e);
+        }
+    }
+    s->done++;
+}
+
+/**
+ * @brief Queues one encoded command, draining a result first if the pipeline is full.
+ *
+ * @param s The stream state.
+ * @param addr The address the command accesses.
+ * @param cmd The encoded command word.
+ * @param expect The expected (masked) read data, or `RAM_STREAM_NO_CHECK`.
+ */
+static __force_inline void ram_check_stream_issue(ram_check_stream_t *s, uint32_t addr,
+                                                  uint32_t cmd, uint32_t expect)
+{
+    if (s->issued - s->done == RAM_STREAM_DEPTH) {
+        ram_check_stream_drain_one(s);
+    }
+    s->expect[s->issued % RAM_STREAM_DEPTH] = expect;
+    s->addr[s->issued % RAM_STREAM_DEPTH] = addr;
+    row_age_touch(addr);
+    pio_sm_put(pio, sm, cmd);
+    s->issued++;
+}
+
+/**
+ * @brief Drains and checks every command still in flight.
+ *
+ * @param s The stream state.
+ * @return True if no read in the stream has failed.
+ */
+static inline bool ram_check_stream_finish(ram_check_stream_t *s)
+{
+    while (s->done != s->issued) {
+        ram_check_stream_drain_one(s);
+    }
+    return (s->failures == 0);
+}
+
+#endif //RAM_STREAM_H
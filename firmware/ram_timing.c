@@ -0,0 +1,87 @@
+/*
+ * ram_timing.c
+ *
+ * Turns datasheet timing parameters into the delay fields of the PIO
+ * programs. Each program lists the intervals between its pin edges as a
+ * fixed number of cycles plus some delay fields, and names the parameter
+ * each interval must meet. Working through the rules in order, every
+ * field is raised only as far as the tightest rule needs, which gives the
+ * shortest legal cycle at the clock in use.
+ */
+
+#include <string.h>
+#include "ram_timing.h"
+
+/**
+ * @brief Generates the delay table for one speed grade at a clock.
+ *
+ * @param timing The datasheet timing of the grade.
+ * @param rules The rules of the PIO program the table is for.
+ * @param sys_khz The clock the PIO runs at.
+ * @param delays Receives the table, 32 entries with field 0 unused.
+ * @return False if some interval cannot be met within the fields' 5 bits.
+ */
+bool ram_timing_generate(const ram_timing_t *timing, const ram_timing_rules_t *rules, uint32_t sys_khz,
+                         uint8_t *delays)
+{
+    // ram_timing_t is all uint16_t, in ram_timing_param_t order
+    const uint16_t *ns = (const uint16_t *)timing;
+    const ram_timing_rule_t *r;
+    uint32_t need;
+    uint32_t have;
+    uint8_t f;
+    uint8_t i;
+
+    memset(delays, 0, 32);
+    for (i = 0; i < rules->num_rules; i++) {
+        r = &rules->rules[i];
+        // Whole cycles needed, rounding up
+        need = (ns[r->param] * sys_khz + 999999) / 1000000;
+        have = r->fixed;
+        for (f = 1; f < rules->delay_fields; f++) {
+            if (r->fields & RAM_FIELD(f))
+                have += delays[f];
+        }
+        if (have >= need)
+            continue;
+        need -= have;
+        if (delays[r->owner] + need > 31) {
+            if (!r->spill || (delays[r->spill] + delays[r->owner] + need > 62))
+                return false;
+            delays[r->spill] += delays[r->owner] + need - 31;
+            delays[r->owner] = 31;
+        } else {
+            delays[r->owner] += need;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Returns the length of the interval a timing parameter constrains.
+ *
+ * @param rules The rules of the PIO program.
+ * @param param The parameter whose first rule is measured.
+ * @param delays The delay table of the program.
+ * @return The interval in PIO cycles, or 0 if no rule names the parameter.
+ */
+uint32_t ram_timing_interval(const ram_timing_rules_t *rules, ram_timing_param_t param, const uint8_t *delays)
+{
+    const ram_timing_rule_t *r;
+    uint32_t cycles;
+    uint8_t f;
+    uint8_t i;
+
+    for (i = 0; i < rules->num_rules; i++) {
+        r = &rules->rules[i];
+        if (r->param != param)
+            continue;
+        cycles = r->fixed;
+        for (f = 1; f < rules->delay_fields; f++) {
+            if (r->fields & RAM_FIELD(f))
+                cycles += delays[f];
+        }
+        return cycles;
+    }
+    return 0;
+}
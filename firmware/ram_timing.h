@@ -0,0 +1,73 @@
+#ifndef RAM_TIMING_H
+#define RAM_TIMING_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Cycles the PIO input synchronizer delays every read of a data pin
+#define RAM_TIMING_SYNC_CYCLES 2
+
+/**
+ * @brief Datasheet timing of one speed grade, in nanoseconds.
+ *
+ * All are minimums except tRAC and tCAC, the access times, which are the
+ * maximum delay before read data is valid.
+ */
+typedef struct {
+    uint16_t trac; // Access time from RAS#
+    uint16_t tcac; // Access time from CAS#
+    uint16_t trc;  // Random read or write cycle time
+    uint16_t tras; // RAS# pulse width
+    uint16_t trp;  // RAS# precharge time
+    uint16_t trcd; // RAS# to CAS# delay
+    uint16_t tcas; // CAS# pulse width
+    uint16_t tcp;  // CAS# precharge time in page mode
+    uint16_t twp;  // Write pulse width
+} ram_timing_t;
+
+// Parameters of ram_timing_t, in member order
+typedef enum {
+    RAM_TRAC,
+    RAM_TCAC,
+    RAM_TRC,
+    RAM_TRAS,
+    RAM_TRP,
+    RAM_TRCD,
+    RAM_TCAS,
+    RAM_TCP,
+    RAM_TWP
+} ram_timing_param_t;
+
+/**
+ * @brief One interval of a PIO program that a timing parameter constrains.
+ *
+ * The interval lasts `fixed` cycles plus the delays of the fields in
+ * `fields`. If it is too short, `owner` takes the shortfall; whatever does
+ * not fit in its 5 bits goes to `spill`.
+ */
+typedef struct {
+    uint8_t param;   // ram_timing_param_t
+    uint8_t fixed;   // Cycles of the interval outside the delay fields
+    uint8_t owner;   // Field lengthened to meet the parameter
+    uint8_t spill;   // Field taking what the owner cannot, 0 for none
+    uint32_t fields; // Bit mask of the fields inside the interval
+} ram_timing_rule_t;
+
+/**
+ * @brief How the timing parameters map onto the delay fields of one PIO program.
+ */
+typedef struct {
+    uint8_t num_rules;
+    uint8_t delay_fields;
+    const ram_timing_rule_t *rules;
+} ram_timing_rules_t;
+
+// Bit for delay field `f` in ram_timing_rule_t.fields
+#define RAM_FIELD(f) (1u << (f))
+
+// Function prototypes
+bool ram_timing_generate(const ram_timing_t *timing, const ram_timing_rules_t *rules, uint32_t sys_khz,
+                         uint8_t *delays);
+uint32_t ram_timing_interval(const ram_timing_rules_t *rules, ram_timing_param_t param, const uint8_t *delays);
+
+#endif // RAM_TIMING_H
@@ -0,0 +1,60 @@
+/*
+ * row_age.c
+ *
+ * Row access-age tracker. With ROW_AGE_TRACKING set, every path that sends
+ * commands to the state machine reports the rows it activates, and the
+ * longest gap between activations of each row is kept. A row left longer
+ * than its refresh window may lose data through no fault of its own, so
+ * the worst age of each test tells a refresh-starved failure from a real one.
+ */
+
+#include "row_age.h"
+
+uint32_t row_age_mask;
+uint32_t row_age_last_us[ROW_AGE_ROWS];
+uint32_t row_age_max_us[ROW_AGE_ROWS];
+
+/**
+ * @brief Starts tracking with every row treated as just activated.
+ *
+ * @param row_bits Low address bits that form the row address.
+ */
+void row_age_start(uint32_t row_bits)
+{
+    uint32_t now = time_us_32();
+    uint32_t row;
+
+    row_age_mask = (1 << row_bits) - 1;
+    for (row = 0; row <= row_age_mask; row++)
+    {
+        row_age_last_us[row] = now;
+        row_age_max_us[row] = 0;
+    }
+}
+
+/**
+ * @brief Ends tracking and returns the worst row age seen.
+ *
+ * Rows not activated since their last access are aged up to now.
+ *
+ * @param limit_us The refresh window each row should stay inside.
+ * @param violations Receives the number of rows that exceeded `limit_us`.
+ * @return The longest time any row went without an activation, in microseconds.
+ */
+uint32_t row_age_finish(uint32_t limit_us, uint32_t *violations)
+{
+    uint32_t now = time_us_32();
+    uint32_t worst = 0;
+    uint32_t age;
+    uint32_t row;
+
+    *violations = 0;
+    for (row = 0; row <= row_age_mask; row++)
+    {
+        age = MAX(row_age_max_us[row], now - row_age_last_us[row]);
+        if (age > limit_us)
+            (*violations)++;
+        worst = MAX(worst, age);
+    }
+    return worst;
+}
@@ -0,0 +1,66 @@
+#ifndef ROW_AGE_H
+#define ROW_AGE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "pico/stdlib.h"
+#include "app_state.h"
+
+// Largest number of rows of any supported chip
+#define ROW_AGE_ROWS 512
+
+// Tracker state, kept here so the touch calls inline into the access paths
+extern uint32_t row_age_mask;
+extern uint32_t row_age_last_us[ROW_AGE_ROWS];
+extern uint32_t row_age_max_us[ROW_AGE_ROWS];
+
+// Function prototypes
+void row_age_start(uint32_t row_bits);
+uint32_t row_age_finish(uint32_t limit_us, uint32_t *violations);
+
+/**
+ * @brief Records an activation of the row holding `addr`.
+ *
+ * Compiles to nothing unless ROW_AGE_TRACKING is set.
+ *
+ * @param addr The address accessed.
+ */
+static __force_inline void row_age_touch(uint32_t addr)
+{
+    uint32_t now;
+    uint32_t row;
+
+    if (ROW_AGE_TRACKING) {
+        now = time_us_32();
+        row = addr & row_age_mask;
+        row_age_max_us[row] = MAX(row_age_max_us[row], now - row_age_last_us[row]);
+        row_age_last_us[row] = now;
+    }
+}
+
+/**
+ * @brief Records the activations of a run of accesses.
+ *
+ * A run along one row activates that row; a run of consecutive addresses
+ * activates one row per address until every row has been covered.
+ *
+ * @param addr The first address of the run.
+ * @param stride The address step between accesses.
+ * @param count The number of accesses.
+ */
+static inline void row_age_touch_run(uint32_t addr, uint32_t stride, uint32_t count)
+{
+    uint32_t i;
+
+    if (ROW_AGE_TRACKING) {
+        if ((stride & row_age_mask) == 0) {
+            row_age_touch(addr);
+        } else {
+            for (i = 0; i < MIN(count, row_age_mask + 1); i++) {
+                row_age_touch(addr + i * stride);
+            }
+        }
+    }
+}
+
+#endif //ROW_AGE_H
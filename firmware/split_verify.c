@@ -0,0 +1,133 @@
+/*
+ * split_verify.c
+ *
+ * Split execution of the pseudo-random verify pass. Core1 only issues
+ * reads and hands the raw results to core0 through a lock-free SPSC ring
+ * of blocks. Core0 regenerates the expected stream from the seed with its
+ * own generator state and checks the results between UI ticks, so the
+ * compare never holds up the next burst on the DRAM bus.
+ */
+
+#include "split_verify.h"
+#include "app_state.h"
+#include "failure_map.h"
+#include "xoroshiro64starstar.h"
+
+split_ring_t split_ring;
+
+// Job set up by core1 in split_verify_begin. `split_job` changes for every
+// job so core0 knows when to reseed.
+static uint64_t split_seed;
+static uint32_t split_bits;
+static volatile uint32_t split_job;
+static volatile bool split_active;
+
+// Written by core0 only
+static volatile uint32_t split_failures;
+
+// Core0's generator, and the bits left over from its last 32-bit draw
+static uint32_t split_state[2];
+static uint32_t split_rand;
+static uint32_t split_rand_bits;
+static uint32_t split_seen_job;
+
+/**
+ * @brief Starts a verify job (core1).
+ *
+ * @param seed The seed the data was written with.
+ * @param bits The number of data bits in the RAM chip.
+ */
+void split_verify_begin(uint64_t seed, uint32_t bits)
+{
+    split_ring.head = 0;
+    split_ring.tail = 0;
+    split_seed = seed;
+    split_bits = bits;
+    split_failures = 0;
+    split_job = split_job + 1;
+    __dmb(); // Publish the job before marking it active
+    split_active = true;
+}
+
+/**
+ * @brief Returns the failures core0 has found so far in the current job.
+ *
+ * @return The number of mismatched words.
+ */
+uint32_t split_verify_failures()
+{
+    return split_failures;
+}
+
+/**
+ * @brief Waits for core0 to check every published block and ends the job (core1).
+ *
+ * @return The number of mismatched words.
+ */
+uint32_t split_verify_end()
+{
+    while (split_ring.tail != split_ring.head) {} // Wait for core0 to catch up
+    __dmb();
+    split_active = false;
+    return split_failures;
+}
+
+/**
+ * @brief Generates the next expected word of the current job.
+ *
+ * Draws bits the same way as psrand_next_bits in dram_tests.c, so the
+ * streams match as long as each pass starts on a 32-bit boundary.
+ */
+static inline uint32_t split_next_bits()
+{
+    uint32_t out;
+
+    if (split_rand_bits < split_bits)
+    {
+        split_rand = psrand_next_state(split_state);
+        split_rand_bits = 32;
+    }
+    out = split_rand & ((1 << split_bits) - 1);
+    split_rand = split_rand >> split_bits;
+    split_rand_bits -= split_bits;
+    return out;
+}
+
+/**
+ * @brief Checks the oldest published block, if any (core0).
+ *
+ * Call from the core0 main loop. Handles at most one block per call so the
+ * UI stays responsive.
+ */
+void split_verify_poll()
+{
+    split_block_t *b;
+    uint32_t expect;
+    uint32_t j;
+
+    if (!split_active || (split_ring.tail == split_ring.head))
+        return;
+    __dmb(); // Read the slot only after seeing the new head
+
+    if (split_seen_job != split_job)
+    {
+        split_seen_job = split_job;
+        psrand_seed_state(split_state, split_seed);
+        split_rand_bits = 0;
+    }
+
+    b = &split_ring.slot[split_ring.tail % SPLIT_RING_SLOTS];
+    for (j = 0; j < b->count; j++)
+    {
+        expect = split_next_bits();
+        if (b->data[j] != expect)
+        {
+            split_failures = split_failures + 1;
+            if (failure_map_mode)
+                failure_map_record(b->addr + j * b->stride, b->data[j] ^ expect);
+        }
+    }
+
+    __dmb(); // Finish with the slot before handing it back
+    split_ring.tail = split_ring.tail + 1;
+}
@@ -0,0 +1,57 @@
+#ifndef SPLIT_VERIFY_H
+#define SPLIT_VERIFY_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "hardware/sync.h"
+
+// Words per ring slot. Matches RAM_BLOCK_SIZE in dram_tests.c.
+#define SPLIT_BLOCK_SIZE 256
+// Slots in the ring. Must be a power of 2.
+#define SPLIT_RING_SLOTS 8
+
+// One block of read results on its way from core1 to core0
+typedef struct {
+    uint32_t addr;                   // Address of the first word
+    uint32_t stride;                 // Address step between words
+    uint32_t count;                  // Words in `data`
+    uint32_t data[SPLIT_BLOCK_SIZE]; // Read results
+} split_block_t;
+
+// Lock-free single-producer/single-consumer ring. Core1 only writes `head`
+// and core0 only writes `tail`, so neither needs a lock.
+typedef struct {
+    volatile uint32_t head;                 // Blocks published by core1
+    volatile uint32_t tail;                 // Blocks released by core0
+    split_block_t slot[SPLIT_RING_SLOTS];
+} split_ring_t;
+
+extern split_ring_t split_ring;
+
+// Function prototypes
+void split_verify_begin(uint64_t seed, uint32_t bits);
+uint32_t split_verify_failures();
+uint32_t split_verify_end();
+void split_verify_poll();
+
+/**
+ * @brief Returns the next free slot for core1 to read into, waiting if the ring is full.
+ *
+ * @return The slot. It belongs to core1 until `split_ring_publish`.
+ */
+static inline split_block_t *split_ring_claim()
+{
+    while (split_ring.head - split_ring.tail == SPLIT_RING_SLOTS) {} // Core0 is behind
+    return &split_ring.slot[split_ring.head % SPLIT_RING_SLOTS];
+}
+
+/**
+ * @brief Hands the claimed slot to core0.
+ */
+static inline void split_ring_publish()
+{
+    __dmb(); // The slot contents must be visible before the new head
+    split_ring.head = split_ring.head + 1;
+}
+
+#endif //SPLIT_VERIFY_H
@@ -6,10 +6,13 @@
  * and user input from buttons and rotary encoder.
  */
 #include <stdio.h>
+#include <stdarg.h>
 
 #include "ui.h"
 #include "app_state.h"
 #include "dram_tests.h"
+#include "ram_refresh.h"
+#include "pio_patcher.h"
 #include "hardware.h"
 #include "st7789.h"
 #include "sserif16.h"
@@ -28,6 +31,15 @@
 // Y-coordinate for the cell status display
 #define CELL_STAT_Y 33
 
+// Longest profile menu line, name and estimated duration
+#define PROFILE_TEXT_LEN 24
+
+// Longest options menu line, option name and setting
+#define OPTION_TEXT_LEN 28
+
+// Longest report line
+#define REPORT_TEXT_LEN 28
+
 // Forward declarations for functions used in this file
 void start_the_ram_test();
 void stop_the_ram_test();
@@ -109,6 +121,219 @@ void show_speed_menu()
     gui_listbox(cur_menu, LIST_ACTION_NONE);
 }
 
+/**
+ * @brief Estimates how long a test profile takes on the selected chip and speed grade.
+ *
+ * Random accesses are charged the interval of the chip's tRC rule. Row
+ * bursts are charged a page mode step, CAS# low to CAS# low, which is the
+ * interval of its tCAS rule plus that of its tCP rule. Both use the grade's
+ * delays at the base clock, and chips without page mode pay tRC for all. No
+ * access is charged less than ESTIMATE_CPU_NS, the CPU time per access,
+ * and the refresh test's wait is added. Refresh cycles are left out.
+ *
+ * @param id The test profile.
+ * @return The estimated duration in milliseconds.
+ */
+static uint32_t estimate_profile_ms(test_profile_id_t id)
+{
+    const mem_chip_t *chip = chip_list[main_menu.sel_line];
+    const uint8_t *delays = chip->delays[speed_menu.sel_line];
+    uint64_t random_ps = pio_timing_interval_ps(chip->timing_rules, RAM_TRC, delays, PIO_TIMING_BASE_KHZ);
+    uint64_t page_ps = 0;
+    uint64_t accesses = test_profile_accesses(id, chip->mem_size, chip->bits);
+    uint64_t page_accesses = test_profile_page_accesses(id, chip->mem_size);
+
+    if (chip->page_mode)
+        page_ps = pio_timing_interval_ps(chip->timing_rules, RAM_TCAS, delays, PIO_TIMING_BASE_KHZ) +
+                  pio_timing_interval_ps(chip->timing_rules, RAM_TCP, delays, PIO_TIMING_BASE_KHZ);
+    if (page_ps == 0)
+        page_ps = random_ps;
+    random_ps = MAX(random_ps, ESTIMATE_CPU_NS * 1000ULL);
+    page_ps = MAX(page_ps, ESTIMATE_CPU_NS * 1000ULL);
+    return (uint32_t)(((accesses - page_accesses) * random_ps + page_accesses * page_ps) / 1000000000ULL) +
+           test_profile_wait_us(id) / 1000;
+}
+
+/**
+ * @brief Displays the test profile menu for the selected chip and speed grade.
+ *
+ * Each profile is listed with its estimated duration.
+ */
+void show_profile_menu()
+{
+    static char profile_text[NUM_TEST_PROFILES][PROFILE_TEXT_LEN];
+    uint32_t ms;
+    uint i;
+
+    for (i = 0; i < NUM_TEST_PROFILES; i++) {
+        ms = estimate_profile_ms(i);
+        if (ms < 120000) {
+            snprintf(profile_text[i], PROFILE_TEXT_LEN, "%s  ~%lu s", test_profile_name(i),
+                     (unsigned long)((ms + 999) / 1000));
+        } else {
+            snprintf(profile_text[i], PROFILE_TEXT_LEN, "%s  ~%lu min", test_profile_name(i),
+                     (unsigned long)((ms + 59999) / 60000));
+        }
+        profile_menu_items[i] = profile_text[i];
+    }
+    profile_menu_items[NUM_TEST_PROFILES] = "Options...";
+    cur_menu = &profile_menu;
+    paint_dialog("Select Test Depth");
+    gui_listbox(cur_menu, LIST_ACTION_NONE);
+}
+
+/**
+ * @brief Names a delay field of the selected chip by the timing parameter that sets it.
+ *
+ * @param field The delay field.
+ * @return The name of the first parameter whose rule lengthens the field, or "" if none does.
+ */
+static const char *delay_field_name(uint8_t field)
+{
+    static const char *param_names[] = {"tRAC", "tCAC", "tRC", "tRAS", "tRP", "tRCD", "tCAS", "tCP", "tWP"};
+    const ram_timing_rules_t *rules = chip_list[main_menu.sel_line]->timing_rules;
+    uint i;
+
+    for (i = 0; i < rules->num_rules; i++) {
+        if ((rules->rules[i].owner == field) && (rules->rules[i].param < count_of(param_names)))
+            return param_names[rules->rules[i].param];
+    }
+    return "";
+}
+
+/**
+ * @brief Steps a shmoo axis on to the next delay field of the selected chip.
+ *
+ * Field 0 is never swept, so the axis wraps from the last field back to 1.
+ *
+ * @param field The field the axis sweeps, updated in place.
+ */
+static void shmoo_field_next(uint8_t *field)
+{
+    uint8_t fields = chip_list[main_menu.sel_line]->delay_fields;
+
+    *field = (*field + 1 < fields) ? *field + 1 : 1;
+}
+
+/**
+ * @brief Writes the options menu row of one option, its name and current setting.
+ *
+ * @param id The option.
+ * @param text Buffer of OPTION_TEXT_LEN characters receiving the row.
+ */
+static void option_text(option_id_t id, char *text)
+{
+    switch (id) {
+        case OPTION_MARCH:
+            snprintf(text, OPTION_TEXT_LEN, "March: %s", march_algorithm_name(march_algorithm));
+            break;
+        case OPTION_FAILURE_MAP:
+            snprintf(text, OPTION_TEXT_LEN, "Map failures: %s", failure_map_mode ? "On" : "Off");
+            break;
+        case OPTION_RETENTION:
+            snprintf(text, OPTION_TEXT_LEN, "Retention search: %s", refresh_characterize ? "On" : "Off");
+            break;
+        case OPTION_VERIFY:
+            snprintf(text, OPTION_TEXT_LEN, "Verify: %s",
+                     split_verify_mode ? "Split cores" : (crc_verify_mode ? "DMA CRC" : "In line"));
+            break;
+        case OPTION_SHMOO:
+            snprintf(text, OPTION_TEXT_LEN, "Timing shmoo: %s", shmoo_mode ? "On" : "Off");
+            break;
+        case OPTION_SHMOO_X:
+            snprintf(text, OPTION_TEXT_LEN, "Shmoo X: field %u %s", shmoo_field_x, delay_field_name(shmoo_field_x));
+            break;
+        case OPTION_SHMOO_Y:
+            snprintf(text, OPTION_TEXT_LEN, "Shmoo Y: field %u %s", shmoo_field_y, delay_field_name(shmoo_field_y));
+            break;
+        case OPTION_BIN:
+            snprintf(text, OPTION_TEXT_LEN, "Speed binning: %s", bin_mode ? "On" : "Off");
+            break;
+        case OPTION_CLOCK:
+            if (timing_mode)
+                snprintf(text, OPTION_TEXT_LEN, "PIO clock: Best fit");
+            else
+                snprintf(text, OPTION_TEXT_LEN, "PIO clock: %lu MHz", (unsigned long)(PIO_TIMING_BASE_KHZ / 1000));
+            break;
+        default:
+            text[0] = '\0';
+            break;
+    }
+}
+
+/**
+ * @brief Steps one option on to its next setting, wrapping around after the last.
+ *
+ * @param id The option.
+ */
+static void option_next(option_id_t id)
+{
+    switch (id) {
+        case OPTION_MARCH:
+            march_algorithm = (march_algorithm + 1) % NUM_MARCH_ALGORITHMS;
+            break;
+        case OPTION_FAILURE_MAP:
+            failure_map_mode = !failure_map_mode;
+            break;
+        case OPTION_RETENTION:
+            refresh_characterize = !refresh_characterize;
+            break;
+        case OPTION_VERIFY:
+            // In line, then split cores, then DMA CRC
+            if (split_verify_mode) {
+                split_verify_mode = false;
+                crc_verify_mode = true;
+            } else if (crc_verify_mode) {
+                crc_verify_mode = false;
+            } else {
+                split_verify_mode = true;
+            }
+            break;
+        case OPTION_SHMOO:
+            // The shmoo and binning each replace the tests, so only one can be on
+            shmoo_mode = !shmoo_mode;
+            if (shmoo_mode)
+                bin_mode = false;
+            break;
+        case OPTION_SHMOO_X:
+            shmoo_field_next(&shmoo_field_x);
+            break;
+        case OPTION_SHMOO_Y:
+            shmoo_field_next(&shmoo_field_y);
+            break;
+        case OPTION_BIN:
+            bin_mode = !bin_mode;
+            if (bin_mode)
+                shmoo_mode = false;
+            break;
+        case OPTION_CLOCK:
+            timing_mode = !timing_mode;
+            break;
+        default:
+            break;
+    }
+}
+
+/**
+ * @brief Displays the options menu, each option with its current setting.
+ *
+ * Clicking a row steps that option to its next setting. The options apply
+ * to every test run until they are changed again.
+ */
+void show_options_menu()
+{
+    static char option_rows[NUM_OPTIONS][OPTION_TEXT_LEN];
+    uint i;
+
+    for (i = 0; i < NUM_OPTIONS; i++) {
+        option_text(i, option_rows[i]);
+        options_menu_items[i] = option_rows[i];
+    }
+    cur_menu = &options_menu;
+    paint_dialog("Options");
+    gui_listbox(cur_menu, LIST_ACTION_NONE);
+}
+
 
 /**
  * @brief Updates a single "dot" in the RAM test visualization area.
@@ -179,10 +404,10 @@ void show_test_gui()
             update_vis_dot(cx, cy, COLOR_DKGRAY);
         }
     }
-    // Reset visualization statistics
+    // Reset visualization statistics. Core1 is idle, so it is safe to publish from here.
+    progress_t start = {0, 0, 0};
     stat_old_addr = 0;
-    stat_cur_bit = 0;
-    stat_cur_subtest = 0;
+    progress_publish(&test_progress, &start);
 
     // Current test indicator
     paint_status(120, 35, 110, "      "); // Clear previous status text
@@ -203,12 +428,35 @@ void start_the_ram_test()
     power_on();
 
     // Configure the PIO for the selected chip, speed grade, and variant
-    chip_list[main_menu.sel_line]->setup_pio(speed_menu.sel_line, variants_menu.sel_line);
+    const mem_chip_t *chip = chip_list[main_menu.sel_line];
+    chip->setup_pio(speed_menu.sel_line, variants_menu.sel_line);
+    if (timing_mode && !bin_mode) {
+        // Regenerate the grade's delays at whichever PIO clock gives the shortest access cycle.
+        // Binning loads each grade's base clock delays itself, so it keeps the base clock.
+        pio_timing_select(&chip->timings[speed_menu.sel_line], chip->timing_rules, &pio_timing);
+        if (pio_timing.sys_khz) {
+            pio_timing_apply(pio_timing.sys_khz);
+            pio_reload_delays(pio, sm, offset, pio_timing.delays, chip->delay_fields);
+        }
+    }
 
     // Prepare and add the RAM test entry to the call queue for the second core
+    test_profile = profile_menu.sel_line;
     queue_entry_t entry = {all_ram_tests,
                            chip_list[main_menu.sel_line]->mem_size,
                            chip_list[main_menu.sel_line]->bits};
+    if (shmoo_mode) {
+        // The grid is exported over USB, so bring up USB stdio the first time it is needed
+        static bool stdio_started = false;
+        if (!stdio_started) {
+            stdio_init_all();
+            stdio_started = true;
+        }
+        entry.func = shmoo_test;
+    } else if (bin_mode) {
+        entry.func = bin_test;
+        paint_status(120, 35, 110, "Binning");
+    }
     queue_add_blocking(&call_queue, &entry);
 }
 
@@ -219,7 +467,9 @@ void start_the_ram_test()
  */
 void stop_the_ram_test()
 {
+    ram_refresh_stop(); // Core1 is done with the state machine
     chip_list[main_menu.sel_line]->teardown_pio();
+    pio_timing_apply(PIO_TIMING_BASE_KHZ); // Back to the clock every delay table was generated for
     power_off();
 }
 
@@ -261,9 +511,11 @@ void do_visualization()
     const uint16_t cmap[] = {COLOR_DKBLUE, COLOR_DKGREEN, COLOR_DKMAGENTA, COLOR_DKYELLOW, COLOR_GREEN};
     int bitsize = chip_list[main_menu.sel_line]->bits;
     // Calculate new address for visualization, scaled by memory size and bitsize
-    int new_addr = stat_cur_addr * 1024 / chip_list[main_menu.sel_line]->mem_size / bitsize;
-    int bit = stat_cur_bit;
-    uint16_t col = cmap[stat_cur_subtest]; // Get color based on current subtest
+    progress_t progress;
+    progress_snapshot(&test_progress, &progress); // Consistent copy of core1's progress
+    int new_addr = progress.addr * 1024 / chip_list[main_menu.sel_line]->mem_size / bitsize;
+    int bit = progress.bit;
+    uint16_t col = cmap[progress.subtest]; // Get color based on current subtest
     int delta, i;
     int ox, oy = 0; // Offsets for visualization area
 
@@ -303,6 +555,173 @@ void do_visualization()
     stat_old_addr = new_addr; // Update old address for next visualization step
 }
 
+/**
+ * @brief Draws the pass/fail grid of the last timing shmoo in the visualization area.
+ *
+ * The swept x field runs left to right and the y field top to bottom.
+ */
+static void show_shmoo_grid()
+{
+    uint16_t cx, cy;
+    for (cy = 0; cy < SHMOO_STEPS; cy++) {
+        for (cx = 0; cx < SHMOO_STEPS; cx++) {
+            update_vis_dot(cx, cy, ((shmoo_grid[cy] >> cx) & 1) ? COLOR_GREEN : COLOR_RED);
+        }
+    }
+}
+
+/**
+ * @brief Prints the pass/fail grid of the last timing shmoo to USB stdio.
+ *
+ * One line per y setting, '.' for a passing point and 'X' for a failing one.
+ * A host with the tester's USB serial port open receives it.
+ */
+static void shmoo_export()
+{
+    uint32_t x, y;
+    const mem_chip_t *chip = chip_list[main_menu.sel_line];
+    printf("shmoo %s %s: x=field %u, y=field %u\n", chip->chip_name,
+           chip->speed_names[speed_menu.sel_line], shmoo_field_x, shmoo_field_y);
+    for (y = 0; y < SHMOO_STEPS; y++) {
+        printf("%2lu ", (unsigned long)y);
+        for (x = 0; x < SHMOO_STEPS; x++) {
+            putchar(((shmoo_grid[y] >> x) & 1) ? '.' : 'X');
+        }
+        putchar('\n');
+    }
+}
+
+/**
+ * @brief Appends one line to the report on the last run, if there is room.
+ *
+ * @param fmt printf-style format of the line.
+ */
+static void report_line(const char *fmt, ...)
+{
+    static char report_rows[REPORT_LINES][REPORT_TEXT_LEN];
+    uint8_t n = report_menu.tot_lines;
+    va_list args;
+
+    if (n == REPORT_LINES)
+        return;
+    va_start(args, fmt);
+    vsnprintf(report_rows[n], REPORT_TEXT_LEN, fmt, args);
+    va_end(args);
+    report_menu_items[n] = report_rows[n];
+    report_menu.tot_lines = n + 1;
+}
+
+/**
+ * @brief Adds the longest any row went unrefreshed in each test to the report.
+ *
+ * Each test that ran gets one line: its worst row age and the number of
+ * rows that went longer than the refresh period of the chip.
+ */
+static void report_row_age()
+{
+    uint32_t limit_us = ram_refresh_period_us(chip_list[main_menu.sel_line]);
+    uint32_t tenths;
+    uint i;
+
+    report_line("Row age limit %lu.%lu ms", (unsigned long)(limit_us / 1000), (unsigned long)(limit_us % 1000 / 100));
+    for (i = 0; i < NUM_RAM_TESTS; i++) {
+        if (!row_age_worst_us[i])
+            continue; // Did not run
+        tenths = row_age_worst_us[i] / 100;
+        report_line("%s %lu.%lums %lu late", (i == 0) ? march_algorithm_name(march_algorithm) : ram_test_names[i],
+                    (unsigned long)(tenths / 10), (unsigned long)(tenths % 10),
+                    (unsigned long)row_age_violations[i]);
+    }
+}
+
+/**
+ * @brief Adds the results of the retention-time search to the report.
+ */
+static void report_retention()
+{
+    const refresh_stress_results_t *r = &refresh_stress_results;
+    uint i;
+
+    report_line("Retention: %lu ms", (unsigned long)r->max_working_delay_ms);
+    if (!r->first_failure_delay_ms)
+        return;
+    report_line("First loss: %lu ms", (unsigned long)r->first_failure_delay_ms);
+    report_line("Lost cells: %lu", (unsigned long)r->failed_addresses);
+    if (chip_list[main_menu.sel_line]->bits == 4)
+        report_line("Weak DQ: %lx", (unsigned long)r->weak_bit_mask);
+    for (i = 0; i < MIN(refresh_stress_config.pattern_iterations, 8); i++) {
+        if (r->pattern_failures[i])
+            report_line("Pattern %u: %lu lost", i, (unsigned long)r->pattern_failures[i]);
+    }
+}
+
+/**
+ * @brief Adds the summary of the failure map to the report.
+ *
+ * Failing cells in few rows and columns point at weak cells, a row or
+ * column with as many failing cells as it is long at a dead line.
+ */
+static void report_failure_map()
+{
+    const mem_chip_t *chip = chip_list[main_menu.sel_line];
+    const failure_summary_t *f = &failure_summary;
+    uint i;
+
+    report_line("Failing cells: %lu", (unsigned long)f->cells);
+    if (!f->cells)
+        return;
+    report_line("Bad rows %lu of %lu", (unsigned long)f->bad_rows, 1UL << chip->row_bits);
+    report_line("Bad cols %lu of %lu", (unsigned long)f->bad_cols, (unsigned long)(chip->mem_size >> chip->row_bits));
+    report_line("Worst row %lu: %lu cells", (unsigned long)f->worst_row, (unsigned long)f->worst_row_cells);
+    report_line("Worst col %lu: %lu cells", (unsigned long)f->worst_col, (unsigned long)f->worst_col_cells);
+    for (i = 0; i < NUM_RAM_TESTS; i++) {
+        if (f->per_test[i])
+            report_line("%s: %lu cells", (i == 0) ? march_algorithm_name(march_algorithm) : ram_test_names[i],
+                        (unsigned long)f->per_test[i]);
+    }
+    if (chip->bits == 4) {
+        for (i = 0; i < 4; i++)
+            report_line("DQ%u: %lu bad reads", i, (unsigned long)f->per_bit_reads[i]);
+    }
+}
+
+/**
+ * @brief Collects the details of the last run that do not fit on the results screen.
+ *
+ * The report is empty when there is nothing more to say than pass or fail.
+ */
+static void build_report()
+{
+    report_menu.tot_lines = 0;
+    report_menu.sel_line = 0;
+    report_menu.start_line = 0;
+    if (shmoo_mode || bin_mode)
+        return;
+
+    if (ROW_AGE_TRACKING) {
+        report_row_age();
+    }
+    if (GOLDEN_IMAGE_COMPARE) {
+        report_line("Golden: %lu bad cells", (unsigned long)golden_mismatch_cells);
+    }
+    if (refresh_characterize) {
+        report_retention();
+    }
+    if (failure_map_mode) {
+        report_failure_map();
+    }
+}
+
+/**
+ * @brief Displays the report on the last run as a list to scroll through.
+ */
+void show_report()
+{
+    cur_menu = &report_menu;
+    paint_dialog("Test Report");
+    gui_listbox(cur_menu, LIST_ACTION_NONE);
+}
+
 /**
  * @brief Manages the status display during a RAM test and checks for test completion.
  *
@@ -315,7 +734,6 @@ void do_status()
 {
     uint32_t retval;
     char retstring[30];
-    uint16_t v;
     static uint16_t v_prev = 0; // This variable is declared but not used.
     int test;
 
@@ -325,7 +743,12 @@ void do_status()
         // Update the status text with the current test being run
         if (queue_try_remove(&stat_cur_test, &test)) {
             paint_status(120, 35, 110, "      "); // Clear previous status
-            paint_status(120, 35, 110, (char *)ram_test_names[test]); // Display current test name
+            if (test == 0) {
+                // The March test is named after the algorithm it runs
+                paint_status(120, 35, 110, (char *)march_algorithm_name(march_algorithm));
+            } else {
+                paint_status(120, 35, 110, (char *)ram_test_names[test]); // Display current test name
+            }
         }
 
         // Check if the RAM test has completed by looking at the results queue
@@ -337,10 +760,40 @@ void do_status()
 
             // Transition to test results state and display outcome
             gui_state = TEST_RESULTS;
+            build_report();
             st7789_fill(STATUS_ICON_X, STATUS_ICON_Y, 32, 32, COLOR_LTGRAY); // Erase drum icon
-            if (retval == 0) { // Test passed
+            if (shmoo_mode) {
+                // Failing points are the point of a shmoo, so show the grid instead of pass/fail
+                show_shmoo_grid();
+                shmoo_export();
+                paint_status(120, 35, 110, "Shmoo");
+                sprintf(retstring, "%lu pass", (unsigned long)(SHMOO_STEPS * SHMOO_STEPS - retval));
+                paint_status(120, 105, 110, retstring);
+            } else if (bin_mode) {
+                if (retval == 0) {
+                    // Show the grade found and select it in the speed menu
+                    speed_menu.sel_line = bin_grade;
+                    speed_menu.start_line = bin_grade;
+                    paint_status(120, 35, 110, (char *)chip_list[main_menu.sel_line]->speed_names[bin_grade]);
+                    draw_icon(STATUS_ICON_X, STATUS_ICON_Y, &check_icon);
+                    sprintf(retstring, "Margin %u", bin_margin);
+                    paint_status(120, 105, 110, retstring);
+                } else {
+                    draw_icon(STATUS_ICON_X, STATUS_ICON_Y, &error_icon);
+                    paint_status(120, 105, 110, "No grade");
+                }
+            } else if (retval == 0) { // Test passed
                 paint_status(120, 35, 110, "Passed!");
                 draw_icon(STATUS_ICON_X, STATUS_ICON_Y, &check_icon);
+                if (refresh_characterize) {
+                    // Show the worst-case retention time
+                    sprintf(retstring, "Ret %lums", (unsigned long)refresh_stress_results.max_working_delay_ms);
+                    paint_status(120, 105, 110, retstring);
+                } else if (timing_mode) {
+                    // Show the PIO clock the delays were fitted to
+                    sprintf(retstring, "%lu MHz", (unsigned long)(pio_timing.sys_khz / 1000));
+                    paint_status(120, 105, 110, retstring);
+                }
             } else { // Test failed
                 draw_icon(STATUS_ICON_X, STATUS_ICON_Y, &error_icon);
                 if (chip_list[main_menu.sel_line]->bits == 4) {
@@ -354,6 +807,11 @@ void do_status()
                     paint_status(120, 105, 110, "Failed"); // Generic failure for other bitsizes
                 }
             }
+            if (failure_map_mode && retval && !shmoo_mode && !bin_mode) {
+                // Show how many distinct cells failed across all tests
+                sprintf(retstring, "%lu cells", (unsigned long)failure_summary.cells);
+                paint_status(120, 35, 110, retstring);
+            }
         }
     }
 }
@@ -366,6 +824,8 @@ void do_status()
  */
 void button_action()
 {
+    uint i;
+
     // Perform action based on the current GUI state
     switch (gui_state) {
         case SPLASH_SCREEN:
@@ -388,11 +848,29 @@ void button_action()
             show_speed_menu();
             break;
         case SPEED_MENU:
+            // Pick how deep to test, with the time each depth takes at this grade
+            gui_state = PROFILE_MENU;
+            show_profile_menu();
+            break;
+        case PROFILE_MENU:
+            if (profile_menu.sel_line == NUM_TEST_PROFILES) {
+                // The last row is not a profile but the way into the options
+                gui_state = OPTIONS_MENU;
+                show_options_menu();
+                break;
+            }
             // Prompt user to place chip and turn on external supply
             gui_messagebox("Place Chip in Socket",
                            "Turn on external supply afterwards, if used.", &chip_icon);
             gui_state = DO_SOCKET;
             break;
+        case OPTIONS_MENU:
+            // Step the selected option and redraw the rows, as it can turn another off
+            option_next(options_menu.sel_line);
+            for (i = 0; i < NUM_OPTIONS; i++)
+                option_text(i, options_menu_items[i]);
+            gui_listbox(cur_menu, LIST_ACTION_NONE);
+            break;
         case DO_SOCKET:
             // Start the RAM test after chip is placed
             gui_state = DO_TEST;
@@ -403,6 +881,7 @@ void button_action()
             // No action during active test, user must wait for completion or press back
             break;
         case TEST_RESULTS:
+        case REPORT_VIEW:
             // Allow quick retest from results screen
             gui_state = DO_TEST;
             show_test_gui();
@@ -445,16 +924,26 @@ void button_back()
                 show_variant_menu();
             }
             break;
-        case DO_SOCKET:
+        case PROFILE_MENU:
             gui_state = SPEED_MENU;
             show_speed_menu();
             break;
+        case OPTIONS_MENU:
+            // The options can change what each profile runs, so estimate again
+            gui_state = PROFILE_MENU;
+            show_profile_menu();
+            break;
+        case DO_SOCKET:
+            gui_state = PROFILE_MENU;
+            show_profile_menu();
+            break;
         case DO_TEST:
             // No action for back button during active test
             break;
         case TEST_RESULTS:
-            gui_state = SPEED_MENU;
-            show_speed_menu();
+        case REPORT_VIEW:
+            gui_state = PROFILE_MENU;
+            show_profile_menu();
             break;
         default:
             gui_state = MAIN_MENU;
@@ -485,8 +974,13 @@ void do_buttons()
 void wheel_increment()
 {
     // Only allow incrementing if a menu is currently active
-    if (gui_state == MAIN_MENU || gui_state == SPEED_MENU || gui_state == VARIANT_MENU) {
+    if (gui_state == MAIN_MENU || gui_state == SPEED_MENU || gui_state == VARIANT_MENU ||
+        gui_state == PROFILE_MENU || gui_state == OPTIONS_MENU || gui_state == REPORT_VIEW) {
         gui_listbox(cur_menu, LIST_ACTION_DOWN);
+    } else if ((gui_state == TEST_RESULTS) && report_menu.tot_lines) {
+        // Turning the wheel on the results screen opens the report
+        gui_state = REPORT_VIEW;
+        show_report();
     }
 }
 
@@ -499,8 +993,13 @@ void wheel_increment()
 void wheel_decrement()
 {
     // Only allow decrementing if a menu is currently active
-    if (gui_state == MAIN_MENU || gui_state == SPEED_MENU || gui_state == VARIANT_MENU) {
+    if (gui_state == MAIN_MENU || gui_state == SPEED_MENU || gui_state == VARIANT_MENU ||
+        gui_state == PROFILE_MENU || gui_state == OPTIONS_MENU || gui_state == REPORT_VIEW) {
         gui_listbox(cur_menu, LIST_ACTION_UP);
+    } else if ((gui_state == TEST_RESULTS) && report_menu.tot_lines) {
+        // Turning the wheel on the results screen opens the report
+        gui_state = REPORT_VIEW;
+        show_report();
     }
 }
 
@@ -11,7 +11,10 @@ void setup_main_menu();
 void show_main_menu();
 void show_variant_menu();
 void show_speed_menu();
+void show_profile_menu();
+void show_options_menu();
 void show_test_gui();
+void show_report();
 void do_visualization();
 void do_status();
 void button_action();
@@ -35,20 +35,32 @@ static inline uint32_t rotl(const uint32_t x, int k) {
 
 static uint32_t s[2];
 
-void psrand_seed(uint64_t seed)
+/* Caller-owned state, so that the other core can regenerate a stream
+   without touching the shared state `s`. */
+
+void psrand_seed_state(uint32_t *st, uint64_t seed)
 {
-    s[0] = seed & 0xFFFFFFFF;
-    s[1] = seed >> 32;
+    st[0] = seed & 0xFFFFFFFF;
+    st[1] = seed >> 32;
 }
 
-uint32_t psrand_next(void) {
-	const uint32_t s0 = s[0];
-	uint32_t s1 = s[1];
+uint32_t psrand_next_state(uint32_t *st) {
+	const uint32_t s0 = st[0];
+	uint32_t s1 = st[1];
 	const uint32_t result = rotl(s0 * 0x9E3779BB, 5) * 5;
 
 	s1 ^= s0;
-	s[0] = rotl(s0, 26) ^ s1 ^ (s1 << 9); // a, b
-	s[1] = rotl(s1, 13); // c
+	st[0] = rotl(s0, 26) ^ s1 ^ (s1 << 9); // a, b
+	st[1] = rotl(s1, 13); // c
 
 	return result;
 }
+
+void psrand_seed(uint64_t seed)
+{
+    psrand_seed_state(s, seed);
+}
+
+uint32_t psrand_next(void) {
+	return psrand_next_state(s);
+}
@@ -3,5 +3,7 @@
 
 void psrand_seed(uint64_t seed);
 uint32_t psrand_next(void);
+void psrand_seed_state(uint32_t *st, uint64_t seed);
+uint32_t psrand_next_state(uint32_t *st);
 
 #endif